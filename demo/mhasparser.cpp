@@ -84,14 +84,12 @@ amm-info@iis.fraunhofer.de
 #include <cinttypes>
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <string>
 
 // External includes
 
 // Internal includes
 #include "mmtmhasparserlib/mhasparser.h"
-#include "mmtmhasparserlib/mhascrc16packet.h"
 
 using namespace mmt::mhasparserlib;
 
@@ -122,8 +120,8 @@ int main(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
-  std::map<uint64_t, uint16_t> crc16map;
   CMhasParser mhasParser;
+  mhasParser.crcVerification(true);
   mhasParser.sync();
 
   ilo::ByteBuffer buffer(8192);
@@ -141,20 +139,12 @@ int main(int argc, char* argv[]) {
     while (CUniqueMhasPacket mhasPacket = mhasParser.nextPacket()) {
       std::cout << mhasPacket->toString(verbose) << std::endl;
 
-      switch (EMhasPacketType(mhasPacket->packetType())) {
-        case EMhasPacketType::PACTYP_CRC16:
-          crc16map[mhasPacket->packetLabel()] =
-              dynamic_cast<CMhasCRC16Packet*>(mhasPacket.get())->crc16();
+      switch (mhasPacket->crcStatus()) {
+        case ECrcStatus::Passed:
+          std::cout << "=> CRC is ok! " << std::endl;
           break;
-
-        case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
-          if (crc16map.count(mhasPacket->packetLabel()) != 0) {
-            if (crc16map[mhasPacket->packetLabel()] != mhasPacket->calculateCRC16()) {
-              std::cout << "=> CRC is NOT ok! " << std::endl;
-            } else {
-              std::cout << "=> CRC is ok! " << std::endl;
-            }
-          }
+        case ECrcStatus::Failed:
+          std::cout << "=> CRC is NOT ok! " << std::endl;
           break;
         default:
           break;
@@ -162,5 +152,11 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  const SMhasCrcCounters& crcCounters = mhasParser.crcCounters();
+  if (crcCounters.passed + crcCounters.failed != 0) {
+    std::cout << "CRC16 verified packets: " << crcCounters.passed + crcCounters.failed
+              << ", failed: " << crcCounters.failed << std::endl;
+  }
+
   return EXIT_SUCCESS;
 }
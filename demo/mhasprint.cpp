@@ -242,10 +242,11 @@ int main(int argc, char* argv[]) {
 
       std::cout << "   Referenced Signal Groups:" << std::endl;
 
-      std::map<std::shared_ptr<CMhasConfigPacket::SSignals3d::SSignalGroup>, std::vector<uint8_t>>
+      std::map<std::shared_ptr<const CMhasConfigPacket::SSignals3d::SSignalGroup>,
+               std::vector<uint8_t>>
           signalMap;
       for (const auto& signal : group.second.signals) {
-        signalMap[signal.signalGroup].push_back(signal.signalNumber);
+        signalMap[info.signalGroups.at(signal.signalGroupIndex)].push_back(signal.signalNumber);
       }
 
       std::string prefix = "     ";
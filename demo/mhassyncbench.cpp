@@ -0,0 +1,179 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mhassyncscanner.h"
+
+using namespace mmt::mhasparserlib;
+
+// The byte-wise loop CMhasParser used to search for the sync packet
+static ilo::ByteBuffer::const_iterator findSyncLegacy(ilo::ByteBuffer::const_iterator begin,
+                                                      ilo::ByteBuffer::const_iterator end) {
+  while (end - begin > 3) {
+    if (begin[0] == 0xC0u && begin[1] == 0x01u && begin[2] == 0xA5u) {
+      return begin;
+    }
+    ++begin;
+  }
+  return end;
+}
+
+static void runBenchmark(const std::string& name, uint32_t iterations, std::size_t bytes,
+                         const std::function<std::size_t()>& scan) {
+  std::size_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; ++i) {
+    checksum += scan();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+
+  const double seconds = std::chrono::duration<double>(stop - start).count();
+  const double megabytes = static_cast<double>(bytes) * iterations / (1024.0 * 1024.0);
+  std::cout << name << ": " << megabytes / seconds << " MiB/s (sync found at offset "
+            << checksum / iterations << ")" << std::endl;
+}
+
+static void printUsage() {
+  std::cout << "Usage: mhassyncbench [<buffer size in MiB>] [<iterations>]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 3) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  const std::size_t sizeMiB = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16u;
+  const auto iterations =
+      static_cast<uint32_t>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20u);
+  if (sizeMiB == 0 || iterations == 0) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  // Random data without any sync byte pattern, followed by a single sync packet at the very end.
+  // This resembles tuning into a stream right after a sync packet has passed.
+  ilo::ByteBuffer buffer(sizeMiB * 1024u * 1024u);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<uint32_t> distribution(0, 255);
+  for (auto& byte : buffer) {
+    byte = static_cast<uint8_t>(distribution(generator));
+    if (byte == 0xC0u) {
+      byte = 0x00u;
+    }
+  }
+  buffer[buffer.size() - 4] = 0xC0u;
+  buffer[buffer.size() - 3] = 0x01u;
+  buffer[buffer.size() - 2] = 0xA5u;
+
+  const uint8_t* begin = buffer.data();
+  const uint8_t* end = begin + buffer.size();
+
+  std::cout << "Searching " << sizeMiB << " MiB for the sync packet, " << iterations
+            << " iterations" << std::endl;
+
+  runBenchmark("Legacy loop", iterations, buffer.size(), [&buffer]() {
+    return static_cast<std::size_t>(findSyncLegacy(buffer.cbegin(), buffer.cend()) -
+                                    buffer.cbegin());
+  });
+  runBenchmark("Scalar", iterations, buffer.size(), [begin, end]() {
+    return static_cast<std::size_t>(findSyncCandidateScalar(begin, end) - begin);
+  });
+  runBenchmark(std::string("Dispatched (") + syncScannerName() + ")", iterations, buffer.size(),
+               [begin, end]() {
+                 return static_cast<std::size_t>(findSyncCandidate(begin, end) - begin);
+               });
+
+  return EXIT_SUCCESS;
+}
@@ -81,6 +81,7 @@ amm-info@iis.fraunhofer.de
 -----------------------------------------------------------------------------*/
 
 // System includes
+#include <array>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -91,7 +92,7 @@ amm-info@iis.fraunhofer.de
 #include "logging.h"
 #include "common.h"
 #include "mmtmhasparserlib/mhasparser.h"
-#include "mmtmhasparserlib/mhasframepacket.h"
+#include "mmtmhasparserlib/mhasconfigpacket.h"
 
 using namespace mmt::mhasparserlib;
 using namespace mmt::isobmff;
@@ -110,6 +111,7 @@ int main(int argc, char** argv) {
 
   uint64_t totDuration = 0;
   uint32_t sampleNumber = 1;
+  bool audioPreRollPresent = false;
 
   do {
     CSample sample = mp4Input.currentSample();
@@ -130,12 +132,32 @@ int main(int argc, char** argv) {
     mhasParser.parsePackets();
 
     CPacketDeque allPackets = mhasParser.allAvailablePackets();
-    for (auto& mhasPacket : allPackets) {
-      if (EMhasPacketType(mhasPacket->packetType()) == EMhasPacketType::PACTYP_MPEGH3DAFRAME) {
-        bool isIpf = dynamic_cast<CMhasFramePacket*>(mhasPacket.get())->isIPF();
-        std::cout << " * IPF             : " << (isIpf ? "yes" : "no") << std::endl;
-        bool isIF = dynamic_cast<CMhasFramePacket*>(mhasPacket.get())->isIF();
-        std::cout << " * IF              : " << (isIF ? "yes" : "no") << std::endl;
+
+    // Index the MHAS packets of the sample without creating packet objects. The scan stops after
+    // each config packet, as it may change whether audio pre-roll is present.
+    const uint8_t* scanPos = sample.rawData.data();
+    const uint8_t* scanEnd = scanPos + sample.rawData.size();
+    std::array<SMhasPacketRecord, 16> records;
+    while (true) {
+      const uint8_t* scanBegin = scanPos;
+      const std::size_t numRecords = CMhasPacket::s_scanPackets(
+          scanPos, scanEnd, records.data(), records.size(), audioPreRollPresent);
+      if (numRecords == 0) {
+        break;
+      }
+
+      for (std::size_t i = 0; i < numRecords; ++i) {
+        const SMhasPacketRecord& record = records[i];
+        const uint8_t* packetBegin = scanBegin + record.offset;
+        if (EMhasPacketType(record.packetType) == EMhasPacketType::PACTYP_MPEGH3DAFRAME) {
+          std::cout << " * IPF             : " << (record.isIPF() ? "yes" : "no") << std::endl;
+          std::cout << " * IF              : " << (record.isIF() ? "yes" : "no") << std::endl;
+        } else if (EMhasPacketType(record.packetType) == EMhasPacketType::PACTYP_MPEGH3DACFG) {
+          SMhasPacketHeader header;
+          CMhasPacket::s_decodeHeader(packetBegin, scanEnd, header);
+          CMhasConfigPacket config(header, packetBegin + header.headerLength);
+          audioPreRollPresent = config.mhasConfigInfo().audioPreRollPresent;
+        }
       }
     }
 
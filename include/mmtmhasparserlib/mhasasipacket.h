@@ -217,7 +217,7 @@ class CMhasAsiPacket final : public CMhasPacket {
       bool onOff = false;
 
       //! The actual condition information, only available if @ref onOff is set to true (on).
-      std::shared_ptr<SCondition> condition = nullptr;
+      std::shared_ptr<const SCondition> condition = nullptr;
     };
 
     /*!
@@ -1238,7 +1238,7 @@ class CMhasAsiPacket final : public CMhasPacket {
       uint16_t dataLength = 0;
 
       //! The actual audio scene data element.
-      std::shared_ptr<SAudioSceneDataElement> data;
+      std::shared_ptr<const SAudioSceneDataElement> data;
     };
 
     //! The data sets contained in the audio scene
@@ -1324,6 +1324,15 @@ class CMhasAsiPacket final : public CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasAsiPacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the ASI packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header. With
+   * @ref EPayloadDecoding::Lazy, the payload is only decoded on first access to @ref
+   * audioSceneInfo, which may happen concurrently from several threads.
+   */
+  CMhasAsiPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                 EPayloadDecoding decoding = EPayloadDecoding::Eager);
 
   /*!
    * @brief Initialize the MHAS packet by reading the given byte range and overwrite the @ref
@@ -1344,12 +1353,36 @@ class CMhasAsiPacket final : public CMhasPacket {
    */
   void payload(ilo::ByteBuffer::const_iterator begin, ilo::ByteBuffer::const_iterator end) override;
 
-  //! Returns the parsed audio scene information structure
-  SAudioSceneInfo audioSceneInfo() const { return m_sceneInfo; }
+  //! Returns the parsed audio scene information structure, which is valid as long as the packet.
+  const SAudioSceneInfo& audioSceneInfo() const;
+
+  /*!
+   * @brief Returns an immutable snapshot of the parsed audio scene information structure.
+   *
+   * The snapshot is shared with the packet instead of being copied and stays valid on its own, so
+   * it can be held beyond the lifetime of the packet. Setting a new payload replaces the audio
+   * scene information structure of the packet but leaves existing snapshots untouched.
+   */
+  std::shared_ptr<const SAudioSceneInfo> audioSceneInfoSnapshot() const;
+
+  /*!
+   * @brief Returns whether the payload has already been decoded into the audio scene information
+   * structure.
+   *
+   * This is only false for packets created with @ref EPayloadDecoding::Lazy which were not
+   * accessed yet.
+   */
+  bool isDecoded() const;
 
  private:
   std::string packetName() const override;
-  SAudioSceneInfo m_sceneInfo;
+  void initFromPayload(EPayloadDecoding decoding);
+  // Returns the audio scene information structure, decoding the payload first if necessary
+  std::shared_ptr<const SAudioSceneInfo> decodedSceneInfo() const;
+
+  // Decoded lazily from const accessors, only accessed with std::atomic_load and friends so that
+  // several threads may decode a shared packet at the same time
+  mutable std::shared_ptr<const SAudioSceneInfo> m_sceneInfo;
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -0,0 +1,210 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhasauassembler.h
+ *
+ * @brief Assembler grouping MHAS packets into timestamped access units
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "version.h"
+#include "mhaspacket.h"
+#include "mhasconfigpacket.h"
+#include "mhastruncationpacket.h"
+
+namespace mmt {
+namespace mhasparserlib {
+//! An access unit assembled by CMhasAuAssembler
+struct SMhasAccessUnit {
+  //! The packet label of the access unit.
+  uint64_t label = 0;
+  //! All MHAS packets of the access unit in stream order, ending with the MHAS frame packet.
+  CPacketDeque packets;
+
+  //! Whether the timestamps are valid, i.e. a config with known output sample rate and frame size
+  //! preceded the access unit.
+  bool hasTiming = false;
+  //! Whether the access unit contains a config which differs from the previous config of its label.
+  bool isConfigChanged = false;
+  //! The output sample rate of the current config in Hz.
+  uint32_t sampleRate = 0;
+  //! The number of output samples truncated by an active MHAS truncation packet.
+  uint32_t truncatedSamples = 0;
+  //! Whether the truncated samples are removed from the beginning (true) or the end (false).
+  bool truncateFromBegin = false;
+
+  //! The presentation timestamp in output samples, i.e. the sum of all previous durations.
+  uint64_t ptsSamples = 0;
+  //! The number of presented output samples, i.e. the frame size minus the truncated samples.
+  uint32_t durationSamples = 0;
+  //! The presentation timestamp in units of the assembler timescale.
+  uint64_t pts = 0;
+  //! The duration in units of the assembler timescale.
+  uint64_t duration = 0;
+};
+
+//! Unique pointer to an assembled access unit
+using CUniqueMhasAccessUnit = std::unique_ptr<SMhasAccessUnit>;
+
+/*!
+ * @brief Groups MHAS packets per packet label into timestamped access units.
+ *
+ * All packets of a label up to and including its next MHAS frame packet form an access unit.
+ * Packets without label (e.g. MHAS sync packets) are added to the access unit of the next labeled
+ * packet.
+ *
+ * Each access unit is stamped with its presentation timestamp and duration, both in output
+ * samples and in the timescale of the assembler. The frame size and output sample rate are taken
+ * from the last config of the label, the samples removed by an active MHAS truncation packet are
+ * subtracted from the duration. Timestamps in the timescale are derived from the total number of
+ * samples since the last change of the sample rate or frame size, so they do not accumulate
+ * rounding errors and stay continuous across config changes.
+ */
+class CMhasAuAssembler {
+ public:
+  //! Creates an assembler stamping access units in units of @p timescale per second.
+  explicit CMhasAuAssembler(uint32_t timescale);
+
+  //! Returns the timescale of the timestamps in units per second.
+  uint32_t timescale() const;
+
+  /*!
+   * @brief Adds the given MHAS packet to the access unit of its label.
+   *
+   * If the packet is an MHAS frame packet, the access unit is completed and becomes available via
+   * @ref nextAccessUnit. Config packets are decoded if their payload differs from the previous
+   * config of the label.
+   */
+  void addPacket(CUniqueMhasPacket packet);
+  //! Adds all given MHAS packets in order, see @ref addPacket.
+  void addPackets(CPacketDeque packets);
+
+  //! Returns the number of completed access units available.
+  uint32_t numAccessUnitsAvailable() const;
+
+  //! Returns the next completed access unit or NULL if there is none.
+  CUniqueMhasAccessUnit nextAccessUnit();
+
+  //! Drops all pending packets and access units and restarts the timestamps at zero.
+  void reset();
+
+ private:
+  // Assembly and timing state of a single packet label
+  struct SStreamState {
+    CPacketDeque packets;
+
+    ilo::ByteBuffer configPayload;
+    bool isConfigChanged = false;
+    uint32_t sampleRate = 0;
+    uint32_t frameSize = 0;
+
+    CMhasTruncationPacket::SMhasTruncationPacketConfig truncation;
+
+    uint64_t ptsSamples = 0;
+    // Timestamp of the last timing change in the assembler timescale and samples since then
+    uint64_t timingStart = 0;
+    uint64_t samplesSinceTimingStart = 0;
+  };
+
+  uint32_t m_timescale = 0;
+  CPacketDeque m_unlabeledPackets;
+  std::map<uint64_t, SStreamState> m_streams;
+  std::deque<CUniqueMhasAccessUnit> m_accessUnits;
+
+  void handleConfig(SStreamState& stream, const CMhasConfigPacket& configPacket);
+  void completeAccessUnit(uint64_t label, SStreamState& stream);
+  uint64_t currentTime(const SStreamState& stream) const;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -88,6 +88,7 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <array>
 #include <map>
 #include <memory>
 #include <string>
@@ -116,6 +117,15 @@ class CMhasConfigPacket final : public CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasConfigPacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the MHAS config packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header. With
+   * @ref EPayloadDecoding::Lazy, the payload is only decoded on first access to @ref
+   * mhasConfigInfo or @ref isLcProfile, which may happen concurrently from several threads.
+   */
+  CMhasConfigPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                    EPayloadDecoding decoding = EPayloadDecoding::Eager);
 
   /*!
    * @brief Initialize the MHAS config packet by reading the given byte range and overwrite the @ref
@@ -199,7 +209,7 @@ class CMhasConfigPacket final : public CMhasPacket {
       ESignalGroupType signalGroupType = ESignalGroupType::INVALID;
 
       //! The speaker configuration for this signal group
-      std::shared_ptr<SSpeakerConfig3d> audioChannelLayout;
+      std::shared_ptr<const SSpeakerConfig3d> audioChannelLayout;
 
       //! The number of signals in this signal group.
       uint32_t numSignals = 0;
@@ -207,10 +217,13 @@ class CMhasConfigPacket final : public CMhasPacket {
 
     //! Representation of a single audio signal
     struct SSignal {
-      //! Referenced signal group
-      std::shared_ptr<SSignalGroup> signalGroup;
+      //! Index of the referenced signal group in @ref signalGroups (255 if unused)
+      uint8_t signalGroupIndex = 255u;
       //! Index of the referenced signal in the signal group
       uint8_t signalNumber = 255u;
+
+      //! Whether this entry references a signal group.
+      bool isValid() const { return signalGroupIndex != 255u; }
     };
 
     //! The total number of higher order ambisonics (HOA) transport channels in all signal groups.
@@ -220,13 +233,38 @@ class CMhasConfigPacket final : public CMhasPacket {
     //! The total number of audio channels in all signal groups.
     uint32_t numAudioChannels = 0u;
     //! The signal groups contained in this configuration.
-    std::vector<std::shared_ptr<SSignalGroup>> signalGroups;
-    //! Map from metadata element ID to signal
-    std::map<uint8_t, SSignal> signals;
+    std::vector<std::shared_ptr<const SSignalGroup>> signalGroups;
+    /*!
+     * @brief Table of signals indexed by the metadata element ID as signaled in the config.
+     *
+     * The IDs in this table do not include the offset of an applied ASI. Use @ref signal to look
+     * up a signal by its (offset) ASI element ID.
+     */
+    std::array<SSignal, 256> signalTable;
+
+    /*!
+     * @brief Returns the signal with the given metadata element ID.
+     *
+     * The ID is interpreted relative to the offset of an applied ASI (see @ref applyAsi). The
+     * returned entry is invalid (see SSignal::isValid) if no signal uses this ID.
+     */
+    const SSignal& signal(uint8_t metaDataElementId) const {
+      return signalTable[static_cast<uint8_t>(metaDataElementId - metaDataElementIdOffset())];
+    }
+
+    //! Returns the signal group referenced by the given signal or nullptr if it is invalid.
+    std::shared_ptr<const SSignalGroup> signalGroup(const SSignal& signal) const;
+
+    //! Returns the offset added to all metadata element IDs by an applied ASI.
+    uint8_t metaDataElementIdOffset() const { return appliedMetaDataElementIdOffset; }
 
     /*!
      * @brief Updates this signal group with data extracted from the given ASI.
      *
+     * The metadata element ID offset is added to SSignalGroup::metaDataElementIds of all signal
+     * groups. The signal table itself stays untouched, @ref signal applies the offset on lookup.
+     * Shifted signal groups are copies, groups shared with other configurations are not modified.
+     *
      * @note Only the first call to this function has any effect, i.e. fields updated from a
      * previous ASI will not be overwritten.
      */
@@ -274,7 +312,7 @@ class CMhasConfigPacket final : public CMhasPacket {
     //! The signals in this configuration
     SSignals3d signals3d;
     //! The (optional) reference layout
-    std::shared_ptr<SSpeakerConfig3d> referenceLayout;
+    std::shared_ptr<const SSpeakerConfig3d> referenceLayout;
 
     //! Flag indicating whether audio pre-roll is present
     bool audioPreRollPresent = false;
@@ -292,15 +330,38 @@ class CMhasConfigPacket final : public CMhasPacket {
     void applyAsi(const CMhasAsiPacket::SAudioSceneInfo& audioSceneInfo);
   };
 
-  //! Returns the configuration structure inside this packet
-  SConfig mhasConfigInfo() const;
+  //! Returns the configuration structure inside this packet, which is valid as long as the packet.
+  const SConfig& mhasConfigInfo() const;
+
+  /*!
+   * @brief Returns an immutable snapshot of the configuration structure inside this packet.
+   *
+   * The snapshot is shared with the packet instead of being copied and stays valid on its own, so
+   * it can be held beyond the lifetime of the packet. Setting a new payload replaces the
+   * configuration structure of the packet but leaves existing snapshots untouched.
+   */
+  std::shared_ptr<const SConfig> mhasConfigSnapshot() const;
+
+  /*!
+   * @brief Returns whether the payload has already been decoded into the configuration structure.
+   *
+   * This is only false for packets created with @ref EPayloadDecoding::Lazy which were not
+   * accessed yet.
+   */
+  bool isDecoded() const;
 
  protected:
   //! Returns the name of this MHAS packet type
   std::string packetName() const override;
 
  private:
-  SConfig m_config;
+  void initFromPayload(EPayloadDecoding decoding);
+  // Returns the configuration structure, decoding the payload first if necessary
+  std::shared_ptr<const SConfig> decodedConfig() const;
+
+  // Decoded lazily from const accessors, only accessed with std::atomic_load and friends so that
+  // several threads may decode a shared packet at the same time
+  mutable std::shared_ptr<const SConfig> m_config;
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -0,0 +1,166 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhascrc16.h
+ *
+ * @brief CRC16 checksum engine for MHAS CRC16 packets
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+
+// Internal includes
+#include "version.h"
+#include "mhaspacket.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief CRC16 as used by MHAS CRC16 packets (polynomial 0x8021, initial value 0xFFFF).
+ *
+ * The checksum can be computed over a whole byte range at once (@ref s_calculate) or
+ * incrementally over consecutive ranges (@ref update or @ref s_update), which yields the same
+ * result as computing it over the concatenated data.
+ *
+ * Several implementations are available. By default, the fastest one supported by the CPU is
+ * selected at runtime: a carry-less multiplication kernel (PCLMULQDQ on x86, PMULL on ARMv8 if
+ * the build enables the crypto extension) for large ranges, and slice-by-16/slice-by-8 lookup
+ * tables otherwise.
+ */
+class CMhasCrc16 {
+ public:
+  //! Available CRC16 implementations
+  enum class EImplementation {
+    //! Select the fastest supported implementation depending on the data size
+    Auto,
+    //! One table lookup per byte
+    Bytewise,
+    //! Eight table lookups per 8 bytes from independent tables
+    SliceBy8,
+    //! Sixteen table lookups per 16 bytes from independent tables
+    SliceBy16,
+    //! Folding with carry-less multiplication (PCLMULQDQ or PMULL)
+    CarrylessMultiply
+  };
+
+  //! The CRC16 generator polynomial (without the leading x^16 term)
+  static const uint16_t POLYNOMIAL = 0x8021u;
+  //! The initial CRC value
+  static const uint16_t INITIAL_VALUE = 0xffffu;
+
+  //! Adds the given bytes to the checksum.
+  void update(const uint8_t* data, std::size_t size);
+  //! Adds the given bytes to the checksum.
+  void update(const SByteSpan& data);
+
+  //! Returns the checksum of all bytes added since construction or the last @ref reset.
+  uint16_t value() const;
+
+  //! Restarts the checksum calculation.
+  void reset();
+
+  //! Returns the checksum of the given bytes.
+  static uint16_t s_calculate(const SByteSpan& data);
+
+  /*!
+   * @brief Continues the checksum @p crc with the given bytes and returns the new checksum.
+   *
+   * Pass @ref INITIAL_VALUE as @p crc to start a new checksum. Throws std::invalid_argument if
+   * the requested implementation is not supported (see @ref s_isSupported).
+   */
+  static uint16_t s_update(uint16_t crc, const uint8_t* data, std::size_t size,
+                           EImplementation implementation = EImplementation::Auto);
+
+  //! Returns whether the given implementation can be used on this CPU.
+  static bool s_isSupported(EImplementation implementation);
+
+  //! Returns the implementation @ref EImplementation::Auto uses for large byte ranges.
+  static EImplementation s_preferredImplementation();
+
+ private:
+  uint16_t m_crc = INITIAL_VALUE;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -110,17 +110,30 @@ class CMhasCRC16Packet final : public CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasCRC16Packet(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the MHAS CRC16 packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   * If @p payloadOwner is set, the payload is shared instead of copied (see @ref EPayloadStorage).
+   */
+  CMhasCRC16Packet(const SMhasPacketHeader& header, const uint8_t* payload,
+                   std::shared_ptr<const uint8_t> payloadOwner = nullptr);
   //! Initialize a new MHAS CRC16 packet with the given label and CRC value
   CMhasCRC16Packet(uint64_t label, uint16_t crc);
 
   //! The 16 Cyclic Redundancy Check (CRC16) value.
   uint16_t crc16() const;
 
+  //! Returns whether the given payload is a valid CRC16 packet payload, without throwing.
+  static bool s_isValidPayload(const SByteSpan& payload);
+
  protected:
   //! Returns the name of this MHAS packet type
   std::string packetName() const override;
 
  private:
+  void initFromPayload();
+
   uint16_t m_crc;
 };
 }  // namespace mhasparserlib
@@ -0,0 +1,216 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhasdecodecache.h
+ *
+ * @brief Cache sharing decoded config and ASI structures between identical payloads
+ */
+#pragma once
+
+// System includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "version.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Thread-safe cache of decoded MHAS payloads, keyed by packet type and payload bytes.
+ *
+ * Broadcast streams repeat byte-identical config and ASI packets with every IPF, often across
+ * many streams. Config and ASI packets look up their decoded structure here (see
+ * @ref s_global), so a repeated payload costs a hash and a comparison instead of a full decode,
+ * and all packets with the same payload share a single immutable structure.
+ *
+ * The cache holds at most @ref maxEntries payloads with at most @ref maxPayloadBytes bytes in
+ * total and evicts the least recently used ones beyond that. Payloads larger than
+ * @ref maxPayloadBytes are decoded but not cached. With a maximum of 0 entries the cache is
+ * disabled and every payload is decoded.
+ *
+ * Decoded structures only reference other structures through pointers to const, so neither a
+ * cached structure nor a copy of it can modify what is shared with other packets.
+ */
+class CMhasDecodeCache {
+ public:
+  //! Default maximum total size in bytes of the cached payloads
+  static const std::size_t DEFAULT_MAX_PAYLOAD_BYTES;
+
+  //! Usage statistics of the cache
+  struct SStatistics {
+    //! Number of lookups which returned a cached structure
+    uint64_t hits = 0;
+    //! Number of lookups which had to decode the payload
+    uint64_t misses = 0;
+    //! Number of entries evicted because the cache was full
+    uint64_t evictions = 0;
+    //! Number of cached entries
+    std::size_t entries = 0;
+    //! Total size in bytes of the cached payloads
+    std::size_t payloadBytes = 0;
+  };
+
+  //! Creates a cache holding at most @p maxEntries decoded payloads of @p maxPayloadBytes in total.
+  explicit CMhasDecodeCache(std::size_t maxEntries = 0,
+                            std::size_t maxPayloadBytes = DEFAULT_MAX_PAYLOAD_BYTES);
+  CMhasDecodeCache(const CMhasDecodeCache&) = delete;
+  CMhasDecodeCache& operator=(const CMhasDecodeCache&) = delete;
+
+  /*!
+   * @brief Returns the process-wide cache used by config and ASI packets.
+   *
+   * It is disabled by default and enabled by setting @ref maxEntries.
+   */
+  static CMhasDecodeCache& s_global();
+
+  //! Sets the maximum number of cached payloads, evicting entries if necessary. 0 disables caching.
+  void maxEntries(std::size_t maxEntries);
+  //! Returns the maximum number of cached payloads.
+  std::size_t maxEntries() const;
+
+  //! Sets the maximum total size in bytes of the cached payloads, evicting entries if necessary.
+  void maxPayloadBytes(std::size_t maxPayloadBytes);
+  //! Returns the maximum total size in bytes of the cached payloads.
+  std::size_t maxPayloadBytes() const;
+
+  /*!
+   * @brief Returns the decoded structure of the given payload of the given packet type.
+   *
+   * On a cache miss, the payload is decoded by calling @p decode, which needs to return a
+   * std::shared_ptr to the decoded structure. Exceptions thrown by @p decode are propagated and
+   * nothing is cached. The lock is not held while decoding.
+   */
+  template <typename TDecoded, typename TDecode>
+  std::shared_ptr<const TDecoded> intern(uint32_t packetType, const ilo::ByteBuffer& payload,
+                                         TDecode decode) {
+    return std::static_pointer_cast<const TDecoded>(
+        internErased(packetType, payload, [&decode]() -> std::shared_ptr<const void> {
+          return decode();
+        }));
+  }
+
+  //! Returns the usage statistics of the cache.
+  SStatistics statistics() const;
+  //! Resets the hit, miss and eviction counters.
+  void resetStatistics();
+  //! Removes all cached entries. Structures still referenced by packets stay valid.
+  void clear();
+
+ private:
+  struct SEntry {
+    uint64_t hash;
+    uint32_t packetType;
+    ilo::ByteBuffer payload;
+    std::shared_ptr<const void> decoded;
+  };
+  using CEntryList = std::list<SEntry>;
+
+  using CErasedDecode = std::function<std::shared_ptr<const void>()>;
+  std::shared_ptr<const void> internErased(uint32_t packetType, const ilo::ByteBuffer& payload,
+                                           const CErasedDecode& decode);
+  // Returns the entry for the given key and marks it as most recently used
+  CEntryList::iterator find(uint64_t hash, uint32_t packetType, const ilo::ByteBuffer& payload);
+  // Evicts least recently used entries until at most the given number and bytes are left
+  void evict(std::size_t maxEntries, std::size_t maxPayloadBytes);
+
+  // Checked without locking, so a disabled cache costs nothing
+  std::atomic<std::size_t> m_maxEntries;
+  mutable std::mutex m_mutex;
+  std::size_t m_maxPayloadBytes;
+  // Most recently used entry first
+  CEntryList m_entries;
+  std::unordered_multimap<uint64_t, CEntryList::iterator> m_index;
+  SStatistics m_statistics;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
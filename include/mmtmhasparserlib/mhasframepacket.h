@@ -88,6 +88,7 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <memory>
 #include <string>
 
 // External includes
@@ -111,6 +112,16 @@ class CMhasFramePacket final : public CMhasPacket {
    */
   CMhasFramePacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end,
                    bool preRollConfigPresent);
+  /*!
+   * @brief Initialize the MHAS frame packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   *
+   * If @p payloadOwner is set, the payload is shared instead of copied (see @ref EPayloadStorage).
+   */
+  CMhasFramePacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                   bool preRollConfigPresent,
+                   std::shared_ptr<const uint8_t> payloadOwner = nullptr);
 
   /*!
    * @brief Initialize the MHAS frame packet by reading the given byte range and overwrite the @ref
@@ -128,6 +139,13 @@ class CMhasFramePacket final : public CMhasPacket {
   //! Validates the frame header and throws an exception on errors.
   void validate() const;
 
+  //! Returns whether the given payload starts with a valid frame header, without throwing.
+  static bool s_isValidPayload(const SByteSpan& payload, bool preRollConfigPresent);
+  //! Returns whether the given frame payload represents an Immediate Playout Frame (IPF).
+  static bool s_isIPF(const SByteSpan& payload, bool preRollConfigPresent);
+  //! Returns whether the given frame payload represents an Independent Frame (IF).
+  static bool s_isIF(const SByteSpan& payload);
+
  protected:
   std::string packetName() const override;
 
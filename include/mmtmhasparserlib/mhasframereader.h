@@ -0,0 +1,181 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhasframereader.h
+ *
+ * @brief Reader returning MHAS packets grouped per frame
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "version.h"
+#include "mhasparser.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Reads MHAS packets and returns them grouped per frame.
+ *
+ * Each call to @ref nextFrame returns all MHAS packets up to and including the next MHAS frame
+ * packet, i.e. the payload of one access unit. The reader keeps a single parser over its whole
+ * input, so every byte is parsed only once: packets parsed beyond the returned frame are kept as
+ * lookahead for the next call.
+ *
+ * The input is either a caller-owned buffer given on construction, which is fed to the parser in
+ * slices of @ref DEFAULT_READ_SIZE bytes as needed, or a stream of buffers passed to @ref feed.
+ */
+class CMhasFrameReader {
+ public:
+  //! Number of bytes of a buffer given on construction fed to the parser at once
+  static const std::size_t DEFAULT_READ_SIZE;
+
+  //! Creates a reader for the buffers passed to @ref feed.
+  CMhasFrameReader();
+  /*!
+   * @brief Creates a reader for the given buffer.
+   *
+   * The buffer is not copied as a whole and must stay valid and unchanged while the reader is
+   * used. Further data can still be appended by calling @ref feed.
+   */
+  CMhasFrameReader(const uint8_t* data, std::size_t size);
+
+  //! Appends the given buffer to the input of the reader.
+  void feed(const ilo::ByteBuffer& buffer);
+  //! Appends the given buffer to the input of the reader. The buffer is copied internally.
+  void feed(const uint8_t* data, std::size_t size);
+
+  /*!
+   * @brief Returns all MHAS packets up to and including the next MHAS frame packet.
+   *
+   * Returns an empty deque if the input does not contain another complete frame yet. The packets
+   * read so far are kept and returned once the frame is complete.
+   */
+  CPacketDeque nextFrame();
+
+  /*!
+   * @brief Returns the number of input bytes consumed by the frames returned so far.
+   *
+   * Bytes dropped by the parser, e.g. while synchronizing, are counted as soon as they are dropped.
+   * If the parser is synchronized on the first input byte and does not drop any bytes, this is the
+   * total size of all returned MHAS packets.
+   */
+  uint64_t position() const;
+
+  /*!
+   * @brief Returns the underlying parser, e.g. to synchronize it or to configure its error
+   * handling.
+   *
+   * @note The parser must not be given an output queue (see @ref CMhasParser::outputQueue) and must
+   * not be fed or parsed directly.
+   */
+  CMhasParser& parser();
+
+ private:
+  CMhasParser m_parser;
+
+  // Caller-owned input buffer and the number of its bytes fed to the parser
+  const uint8_t* m_data = nullptr;
+  std::size_t m_dataSize = 0;
+  std::size_t m_dataFed = 0;
+
+  // Parsed packets not returned yet, their total size and how many of them are known to not be a
+  // frame packet
+  CPacketDeque m_lookahead;
+  uint64_t m_lookaheadBytes = 0;
+  std::size_t m_numScannedPackets = 0;
+
+  uint64_t m_bytesFed = 0;
+  bool m_isParsePending = false;
+
+  bool takeFrame(CPacketDeque& frame);
+  void parsePackets();
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -125,6 +125,9 @@ ilo::CUniqueBuffer insertAsiInConfig(const ilo::ByteBuffer& mpegh3daConfig,
  * track sample.
  *
  * The begin iterator is incremented by the number of bytes read to parse a single full frame.
+ *
+ * @note Packets following the frame are parsed and discarded. Use CMhasFrameReader to read a
+ * buffer frame by frame without parsing it twice.
  */
 CPacketDeque readNextFrame(ilo::ByteBuffer::const_iterator& begin,
                            ilo::ByteBuffer::const_iterator end);
@@ -89,6 +89,8 @@ amm-info@iis.fraunhofer.de
 
 // System includes
 #include <array>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -163,7 +165,7 @@ class CMhasInfoWrapper {
   //! Collected information on a MHAS buffer data
   struct SMhasBufferInfo {
     //! The reference layout for which the content was created (if available).
-    std::shared_ptr<CMhasConfigPacket::SSpeakerConfig3d> referenceLayout;
+    std::shared_ptr<const CMhasConfigPacket::SSpeakerConfig3d> referenceLayout;
     //! Mapping of group IDs to the group information.
     std::map<uint8_t, SGroup> groups;
     //! Mapping of switch group IDs to their switch group info.
@@ -171,12 +173,22 @@ class CMhasInfoWrapper {
     //! Mapping of group preset IDs to group preset info.
     std::map<uint8_t, SGroupPreset> groupPresets;
     //! The signal groups contained in the MHAS stream.
-    std::vector<std::shared_ptr<CMhasConfigPacket::SSignals3d::SSignalGroup>> signalGroups;
-    //! Flag indicating whether a bitstream error occurred and the parser needed to be reset since
-    //! the last time getMhasInfo was called.
+    std::vector<std::shared_ptr<const CMhasConfigPacket::SSignals3d::SSignalGroup>> signalGroups;
+    //! Flag indicating whether a bitstream error occurred and the parser needed to be reset (or to
+    //! resynchronize, see @ref errorHandling) since the last time getMhasInfo was called. In a
+    //! snapshot, it indicates an error since the previous version.
     bool wasResynced = false;
+    //! The version of the MHAS info this structure was taken from (see @ref version).
+    uint64_t version = 0;
   };
 
+  /*!
+   * @brief Callback invoked by @ref feed whenever the MHAS info changed.
+   *
+   * The given snapshot is the one returned by @ref mhasInfoSnapshot afterwards.
+   */
+  using CChangeCallback = std::function<void(const std::shared_ptr<const SMhasBufferInfo>& info)>;
+
   /*!
    * @brief Feed byte buffer to MHAS parser wrapper.
    *
@@ -185,6 +197,15 @@ class CMhasInfoWrapper {
    */
   void feed(const std::vector<uint8_t>& buffer);
 
+  /*!
+   * @brief Sets how the underlying MHAS parser handles corrupted MHAS packets.
+   *
+   * With @ref EErrorHandling::Resilient, corrupted packets are skipped and the parser
+   * resynchronizes in place instead of being reset, keeping the current MHAS info available.
+   * Defaults to @ref EErrorHandling::Strict.
+   */
+  void errorHandling(EErrorHandling errorHandling);
+
   /*!
    * @brief Check whether information of the current MHAS stream is available.
    *
@@ -197,9 +218,33 @@ class CMhasInfoWrapper {
    * @brief Return the current MHAS information from the wrapper.
    *
    * This will throw an exception if @ref isMhasInfoAvailable returns false.
+   *
+   * @note This returns a deep copy. Use @ref mhasInfoSnapshot to poll the info repeatedly.
    */
   SMhasBufferInfo getMhasInfo();
 
+  /*!
+   * @brief Returns the version of the current MHAS info.
+   *
+   * The version is incremented only if the MHAS info actually changed, i.e. on a new config or
+   * ASI, on a bitstream error or if the info becomes (un)available. Repeated config and ASI
+   * packets with identical payloads are not decoded again and do not change the version. This
+   * method may be called from other threads while @ref feed is running.
+   */
+  uint64_t version() const;
+
+  /*!
+   * @brief Returns an immutable snapshot of the current MHAS info.
+   *
+   * The snapshot is created once per version and shared by all callers. It is nullptr while
+   * @ref isMhasInfoAvailable returns false. This method may be called from other threads while
+   * @ref feed is running.
+   */
+  std::shared_ptr<const SMhasBufferInfo> mhasInfoSnapshot() const;
+
+  //! Sets the callback invoked whenever the MHAS info changes (nullptr to disable).
+  void changeCallback(CChangeCallback callback);
+
  private:
   CMhasParser m_mhasParser;
   SMhasBufferInfo m_mhasBufferInfo;
@@ -208,7 +253,19 @@ class CMhasInfoWrapper {
   bool m_isMhasInfoAvailable = false;
   bool m_seekingAsi = false;
 
+  // Payloads the current info was built from, used to skip repeated packets
+  ilo::ByteBuffer m_configPayload;
+  ilo::ByteBuffer m_asiPayload;
+
+  bool m_isChanged = false;
+  bool m_isResyncPending = false;
+  // Polled from other threads, stored after the snapshot of the same version
+  std::atomic<uint64_t> m_version{0};
+  std::shared_ptr<const SMhasBufferInfo> m_snapshot;
+  CChangeCallback m_changeCallback;
+
   void handleParsedPackets();
+  void publishChanges();
   void extractAsiInfo(const CMhasAsiPacket& mhasAsiPacket);
   void initGroups(const CMhasAsiPacket::SAudioSceneInfo& audioScene);
   void initSwitchGroups(const CMhasAsiPacket::SAudioSceneInfo& audioScene);
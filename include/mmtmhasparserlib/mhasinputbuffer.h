@@ -0,0 +1,216 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhasinputbuffer.h
+ *
+ * @brief Circular input buffer used by the MHAS parser
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "version.h"
+#include "mhasmemoryresource.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Circular byte buffer holding the not yet parsed input of the MHAS parser.
+ *
+ * Consuming bytes from the front only advances the read position, and appending reuses the space
+ * freed by consumed bytes. The storage is only reallocated if more bytes are pending than the
+ * capacity can hold, so parsing a stream at steady state does neither move nor allocate memory.
+ *
+ * Since the pending bytes may wrap around the end of the storage, random access is provided by
+ * @ref peek. Contiguous access to the front bytes needs to be requested explicitly with
+ * @ref linearize.
+ *
+ * The storage can be shared with parsed MHAS packets (see @ref storage). While it is shared, bytes
+ * are only appended to the space which was free when it was first shared, and consumed bytes are
+ * not reused. Once that space is exhausted, the storage is retired and the pending bytes are moved
+ * to a spare storage. Retired storage becomes a spare again as soon as all packets referencing it
+ * are released, which is tracked by an atomic release count, so packets may be released from any
+ * thread.
+ */
+class CMhasInputBuffer {
+ public:
+  //! The default capacity in bytes of the input buffer.
+  static const std::size_t DEFAULT_CAPACITY;
+
+  /*!
+   * @brief Creates an empty input buffer with the given capacity in bytes.
+   *
+   * The storage is allocated from @p memoryResource, or from the default resource if none is
+   * given.
+   */
+  explicit CMhasInputBuffer(std::size_t capacity = DEFAULT_CAPACITY,
+                            std::shared_ptr<CMhasMemoryResource> memoryResource = nullptr);
+
+  //! Appends the given byte range to the end of the pending bytes, growing the storage if needed.
+  void append(const uint8_t* data, std::size_t size);
+
+  //! Removes the given number of bytes from the front of the pending bytes.
+  void consume(std::size_t size);
+
+  //! Removes all pending bytes. The capacity remains unchanged.
+  void clear();
+
+  //! Grows the capacity to at least the given number of bytes. The capacity is never reduced.
+  void reserve(std::size_t capacity);
+
+  /*!
+   * @brief Copies up to @p size pending bytes starting at @p offset into @p dest.
+   *
+   * The pending bytes are not consumed.
+   *
+   * @returns the number of bytes copied, which is less than @p size if not enough bytes are
+   * pending.
+   */
+  std::size_t peek(std::size_t offset, uint8_t* dest, std::size_t size) const;
+
+  /*!
+   * @brief Ensures that the first @p size pending bytes are stored contiguously.
+   *
+   * If these bytes currently wrap around the end of the storage, the storage is rotated in place.
+   * This happens at most once per pass through the storage.
+   */
+  void linearize(std::size_t size);
+
+  //! Returns a pointer to the first pending byte.
+  const uint8_t* data() const;
+
+  //! Returns the number of pending bytes which are stored contiguously starting at @ref begin.
+  std::size_t contiguousSize() const;
+
+  //! Returns the number of pending bytes.
+  std::size_t size() const { return m_size; }
+
+  //! Returns whether no bytes are pending.
+  bool empty() const { return m_size == 0; }
+
+  //! Returns the number of bytes the buffer can hold without reallocation.
+  std::size_t capacity() const { return m_capacity; }
+
+  /*!
+   * @brief Returns a reference-counted handle to the current storage.
+   *
+   * Pointers obtained by @ref data stay valid as long as a handle is held, since the buffer does
+   * not overwrite bytes of the storage from then on until all handles are released. All handles to
+   * the same storage share one reference count, so only the first call per storage allocates.
+   */
+  std::shared_ptr<const uint8_t> storage();
+
+  //! Returns the memory resource the storage is allocated from.
+  const std::shared_ptr<CMhasMemoryResource>& memoryResource() const { return m_memoryResource; }
+
+ private:
+  struct SSlab;
+
+  // Moves the pending bytes to the beginning of another storage with the given capacity
+  void reallocate(std::size_t capacity);
+  // Returns a released spare slab of the given capacity, or a newly allocated one
+  std::shared_ptr<SSlab> acquireSlab(std::size_t capacity);
+  bool isShared() const { return m_handle != nullptr; }
+
+  std::shared_ptr<CMhasMemoryResource> m_memoryResource;
+  std::shared_ptr<SSlab> m_slab;
+  // Handle returned by storage() for the current slab, reset when the slab is retired
+  std::shared_ptr<const uint8_t> m_handle;
+  // Retired slabs, which may still be referenced by packets
+  std::vector<std::shared_ptr<SSlab>> m_retiredSlabs;
+  std::size_t m_capacity = 0;
+  std::size_t m_readPos = 0;
+  std::size_t m_size = 0;
+  // Bytes consumed since the current slab was shared, which are not reused until it is retired
+  std::size_t m_sharedSize = 0;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
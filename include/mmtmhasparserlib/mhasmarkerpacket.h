@@ -88,6 +88,7 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -121,6 +122,15 @@ class CMhasMarkerPacket final : public CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasMarkerPacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the MHAS marker packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   *
+   * If @p payloadOwner is set, the payload is shared instead of copied (see @ref EPayloadStorage).
+   */
+  CMhasMarkerPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                    std::shared_ptr<const uint8_t> payloadOwner = nullptr);
   //! Initializes the MHAS marker packet with the given packet label and marker payload bytes.
   CMhasMarkerPacket(uint64_t label, const ilo::ByteBuffer& markers);
 
@@ -130,6 +140,9 @@ class CMhasMarkerPacket final : public CMhasPacket {
  protected:
   //! Returns the name of this MHAS packet type
   std::string packetName() const override;
+
+ private:
+  void initFromPayload();
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhasmemoryresource.h
+ *
+ * @brief Memory resources used for the storage of the MHAS parser and packet pool
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Internal includes
+#include "version.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Interface of a memory resource supplying the storage of the MHAS parser.
+ *
+ * A memory resource can be passed to @ref CMhasParser for its input buffer and to
+ * @ref CMhasPacketPool for the packet objects it creates. Custom resources (e.g. a NUMA-local
+ * arena) are implemented by overriding @ref doAllocate and @ref doDeallocate.
+ *
+ * Components keep a reference to their resource, so it stays alive as long as memory allocated
+ * from it is in use.
+ *
+ * @note Only the input buffer storage of the parser and the packet objects of the pool are
+ * allocated from a resource. The output packet buffer of the parser, owned payload buffers
+ * (including the ones kept by the pool), decoded config and ASI structures, the packet queue and
+ * the decode cache still use the global heap.
+ */
+class CMhasMemoryResource {
+ public:
+  //! Alignment of allocations if none is given
+  static const std::size_t DEFAULT_ALIGNMENT;
+
+  virtual ~CMhasMemoryResource() = default;
+
+  /*!
+   * @brief Allocates @p bytes of memory aligned to @p alignment.
+   *
+   * Throws std::bad_alloc if the memory cannot be allocated.
+   */
+  void* allocate(std::size_t bytes, std::size_t alignment = DEFAULT_ALIGNMENT);
+  //! Deallocates memory returned by @ref allocate with the same size and alignment.
+  void deallocate(void* pointer, std::size_t bytes, std::size_t alignment = DEFAULT_ALIGNMENT);
+
+  //! Returns the resource allocating from the global heap, which is used by default.
+  static std::shared_ptr<CMhasMemoryResource> s_defaultResource();
+
+ protected:
+  //! Allocates @p bytes of memory aligned to @p alignment.
+  virtual void* doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+  //! Deallocates memory returned by @ref doAllocate.
+  virtual void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) = 0;
+};
+
+/*!
+ * @brief Standard allocator allocating from a @ref CMhasMemoryResource.
+ *
+ * Allows standard containers and std::allocate_shared to use a memory resource.
+ */
+template <typename T>
+class CMhasAllocator {
+ public:
+  using value_type = T;
+
+  //! Creates an allocator using the given resource, or the default resource if none is given.
+  explicit CMhasAllocator(std::shared_ptr<CMhasMemoryResource> resource = nullptr)
+      : m_resource(resource ? std::move(resource) : CMhasMemoryResource::s_defaultResource()) {}
+  //! Creates an allocator using the resource of @p other.
+  template <typename U>
+  CMhasAllocator(const CMhasAllocator<U>& other) : m_resource(other.resource()) {}
+
+  //! Allocates memory for @p count objects.
+  T* allocate(std::size_t count) {
+    return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T)));
+  }
+  //! Deallocates memory for @p count objects returned by @ref allocate.
+  void deallocate(T* pointer, std::size_t count) {
+    m_resource->deallocate(pointer, count * sizeof(T), alignof(T));
+  }
+
+  //! Returns the resource this allocator allocates from.
+  const std::shared_ptr<CMhasMemoryResource>& resource() const { return m_resource; }
+
+ private:
+  std::shared_ptr<CMhasMemoryResource> m_resource;
+};
+
+//! Allocators are equal if they allocate from the same resource.
+template <typename T, typename U>
+bool operator==(const CMhasAllocator<T>& lhs, const CMhasAllocator<U>& rhs) {
+  return lhs.resource() == rhs.resource();
+}
+
+//! Allocators are equal if they allocate from the same resource.
+template <typename T, typename U>
+bool operator!=(const CMhasAllocator<T>& lhs, const CMhasAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+}  // namespace mhasparserlib
+}  // namespace mmt
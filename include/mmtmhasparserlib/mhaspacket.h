@@ -88,10 +88,12 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <bitset>
 #include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 
 // External includes
 #include "ilo/common_types.h"
@@ -102,12 +104,92 @@ amm-info@iis.fraunhofer.de
 namespace mmt {
 namespace mhasparserlib {
 class CMhasPacket;
+class CMhasPacketPool;
+
+/*!
+ * @brief Deleter of @ref CUniqueMhasPacket.
+ *
+ * Packets created by a @ref CMhasPacketPool are returned to their pool, all other packets are
+ * deleted. The deleter is implicitly constructible from std::default_delete, so unique pointers to
+ * packets created with std::unique_ptr/make_unique convert to @ref CUniqueMhasPacket.
+ */
+class CMhasPacketDeleter {
+ public:
+  CMhasPacketDeleter() = default;
+  //! Creates a deleter returning packets to the given pool slot
+  CMhasPacketDeleter(std::shared_ptr<CMhasPacketPool> pool, uint32_t slot);
+  //! Creates a deleter for packets allocated with new
+  template <typename TPacket, typename = typename std::enable_if<
+                                 std::is_convertible<TPacket*, CMhasPacket*>::value>::type>
+  CMhasPacketDeleter(const std::default_delete<TPacket>&) {}
+
+  //! Deletes the given packet or returns it to its pool
+  void operator()(CMhasPacket* packet) const;
+
+ private:
+  std::shared_ptr<CMhasPacketPool> m_pool;
+  uint32_t m_slot = 0;
+};
+
 //! Type alias to an unique pointer of the MHAS Packet type
-using CUniqueMhasPacket = std::unique_ptr<CMhasPacket>;
+using CUniqueMhasPacket = std::unique_ptr<CMhasPacket, CMhasPacketDeleter>;
 
 //! Type alias to a deque (bidirectional queue) of MHAS Packets
 using CPacketDeque = std::deque<CUniqueMhasPacket>;
 
+//! Non-owning view of a contiguous byte range
+struct SByteSpan {
+  const uint8_t* data = nullptr;
+  std::size_t size = 0;
+
+  const uint8_t* begin() const { return data; }
+  const uint8_t* end() const { return data + size; }
+  bool empty() const { return size == 0; }
+  const uint8_t& operator[](std::size_t index) const { return data[index]; }
+};
+
+/*!
+ * @brief Defines how parsed MHAS packets store their payload.
+ */
+enum class EPayloadStorage {
+  //! Each packet copies its payload into its own buffer
+  Owned,
+  /*!
+   * Packets keep a reference-counted view into the input chunk they were parsed from. Config, ASI
+   * and truncation packets always use owned storage.
+   */
+  Shared
+};
+
+/*!
+ * @brief Defines when config and ASI packets decode their payload.
+ */
+enum class EPayloadDecoding {
+  //! The payload is decoded when the packet is constructed
+  Eager,
+  /*!
+   * The payload is decoded on first access to the decoded structure, so packets which are only
+   * forwarded never pay for it. Decoding errors are then thrown by the accessor.
+   */
+  Lazy
+};
+
+/*!
+ * @brief Result of the CRC16 verification of a parsed MHAS packet.
+ *
+ * @see CMhasParser::crcVerification
+ */
+enum class ECrcStatus {
+  //! The CRC was not verified
+  NotVerified,
+  //! No MHAS CRC16 packet with the same label preceded the packet
+  Unprotected,
+  //! The CRC of the payload matches the preceding MHAS CRC16 packet
+  Passed,
+  //! The CRC of the payload does not match the preceding MHAS CRC16 packet
+  Failed
+};
+
 /*!
  * @brief Supported MHAS packet types, as defined in ISO/IEC 23008-3 subsection 14.3
  */
@@ -125,6 +207,73 @@ enum class EMhasPacketType : uint32_t {
   PACTYP_FRAMELENGTH = 129,
 };
 
+//! Number of packet types representable by the escaped MHAS packet type field
+//! (escapedValue(3,8,8) covers the values 0 to 517)
+const std::size_t MHAS_PACKET_TYPE_COUNT = 518;
+
+//! Set of MHAS packet types, indexed by packet type
+using CMhasPacketTypeMask = std::bitset<MHAS_PACKET_TYPE_COUNT>;
+
+//! Decoded MHAS packet header (ISO/IEC 23008-3, 14.2.1)
+struct SMhasPacketHeader {
+  uint32_t packetType = 0;
+  uint64_t packetLabel = 0;
+  uint64_t payloadLength = 0;
+  //! Size of the encoded header in bytes
+  std::size_t headerLength = 0;
+
+  //! Returns the total size in bytes of the packet (header + payload).
+  std::size_t packetSize() const { return headerLength + static_cast<std::size_t>(payloadLength); }
+};
+
+/*!
+ * @brief Compact index record of an MHAS packet, filled by @ref CMhasPacket::s_scanPackets.
+ *
+ * A trivially copyable POD, so arrays of records can be provided by the caller without
+ * initialization.
+ */
+struct SMhasPacketRecord {
+  //! Flags of MHAS frame packets, derived from the first payload byte
+  enum EFlags : uint8_t {
+    //! The frame is an Independent Frame (IF)
+    FLAG_IF = 0x01,
+    //! The frame is an Immediate Playout Frame (IPF)
+    FLAG_IPF = 0x02
+  };
+
+  //! Offset in bytes of the packet header from the beginning of the scanned byte range
+  uint64_t offset;
+  //! The packet label
+  uint64_t packetLabel;
+  //! Size of the payload in bytes
+  uint32_t payloadLength;
+  //! The packet type, see @ref EMhasPacketType
+  uint16_t packetType;
+  //! Size of the encoded header in bytes
+  uint8_t headerLength;
+  //! Combination of @ref EFlags
+  uint8_t flags;
+
+  //! Returns the total size in bytes of the packet (header + payload).
+  std::size_t packetSize() const { return headerLength + static_cast<std::size_t>(payloadLength); }
+  //! Returns whether this record represents an Independent Frame (IF).
+  bool isIF() const { return (flags & FLAG_IF) != 0; }
+  //! Returns whether this record represents an Immediate Playout Frame (IPF).
+  bool isIPF() const { return (flags & FLAG_IPF) != 0; }
+};
+
+//! Status of the MHAS packet parse functions which report malformed input by status
+enum class EParseStatus {
+  //! The MHAS packet was parsed successfully
+  Ok,
+  //! The byte range does not contain a complete MHAS packet
+  NeedMoreData,
+  //! The payload of the MHAS packet is invalid for its packet type
+  InvalidPayload
+};
+
+struct SMhasParseResult;
+
 //! Defines the order of MHAS packets for IPFs (as defined in ISO/IEC 23008-3 2nd Ed. Clause 20.6)
 extern const std::map<EMhasPacketType, uint32_t> IPF_PACKETS_ORDER;
 
@@ -145,6 +294,27 @@ class CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasPacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the MHAS packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   *
+   * If @p payloadOwner is set, the payload is not copied. Instead, the packet keeps a view into the
+   * payload and a reference to @p payloadOwner, which must keep the payload alive.
+   */
+  CMhasPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+              std::shared_ptr<const uint8_t> payloadOwner = nullptr);
+  /*!
+   * @brief Copies the given packet.
+   *
+   * A payload borrowed for the duration of a packet handler call (see CMhasParser::parsePackets)
+   * is copied into the new packet's own buffer, so the copy stays valid after the call.
+   */
+  CMhasPacket(const CMhasPacket& other);
+  CMhasPacket(CMhasPacket&& other) = default;
+  //! Copies the given packet, see the copy constructor.
+  CMhasPacket& operator=(const CMhasPacket& other);
+  CMhasPacket& operator=(CMhasPacket&& other) = default;
   virtual ~CMhasPacket() noexcept = default;
 
   /*!
@@ -158,6 +328,107 @@ class CMhasPacket {
                                              ilo::ByteBuffer::const_iterator end,
                                              bool audioPreRollPresent);
 
+  /*!
+   * @brief Parses a single MHAS packet from the given raw byte range.
+   *
+   * The begin pointer is incremented by the number of bytes read to parse the first MHAS packet.
+   *
+   * If @p payloadOwner is set, packet types supporting @ref EPayloadStorage::Shared keep a view
+   * into the given byte range instead of copying their payload.
+   *
+   * @return the parsed MHAS packet representation of the appropriate child-type or NULL.
+   */
+  static CUniqueMhasPacket s_parseNextPacket(
+      const uint8_t*& begin, const uint8_t* end, bool audioPreRollPresent,
+      const std::shared_ptr<const uint8_t>& payloadOwner = nullptr);
+
+  /*!
+   * @brief Creates the MHAS packet of the appropriate child-type from an already decoded packet
+   * header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header. See
+   * the raw byte range overload of @ref s_parseNextPacket for @p payloadOwner. @p decoding applies
+   * to config and ASI packets. If @p pool is set, the packet is created by the given pool.
+   */
+  static CUniqueMhasPacket s_createPacket(
+      const SMhasPacketHeader& header, const uint8_t* payload, bool audioPreRollPresent,
+      const std::shared_ptr<const uint8_t>& payloadOwner = nullptr,
+      EPayloadDecoding decoding = EPayloadDecoding::Eager, CMhasPacketPool* pool = nullptr);
+
+  /*!
+   * @brief Decodes the MHAS packet header at the beginning of the given byte range.
+   *
+   * Only the packet header needs to be covered by the given byte range. The common two byte header
+   * (packet type < 7, packet label < 3, payload length < 2047) is decoded from a single 16 bit
+   * load.
+   *
+   * @returns false if the byte range does not contain the complete packet header.
+   */
+  static bool s_decodeHeader(const uint8_t* begin, const uint8_t* end, SMhasPacketHeader& header);
+
+  /*!
+   * @brief Indexes the complete MHAS packets in the given raw byte range without creating them.
+   *
+   * Up to @p maxRecords records are written to @p records, in stream order. Only the packet
+   * headers and the first payload byte of frames are read, so the scan neither allocates nor
+   * copies or validates payloads. The begin pointer is incremented by the size of the indexed
+   * packets, record offsets are relative to its initial value.
+   *
+   * The IPF flag of frames depends on @p audioPreRollPresent, which is signaled by the preceding
+   * config packet. The scan therefore stops after a config packet, so the caller can update
+   * @p audioPreRollPresent (see @ref CMhasConfigPacket) before continuing the scan.
+   *
+   * @returns the number of records written, which is 0 if no complete packet is left.
+   */
+  static std::size_t s_scanPackets(const uint8_t*& begin, const uint8_t* end,
+                                   SMhasPacketRecord* records, std::size_t maxRecords,
+                                   bool audioPreRollPresent);
+
+  /*!
+   * @brief Parses a single MHAS packet from the given raw byte range and reports malformed input
+   * by status.
+   *
+   * On @ref EParseStatus::Ok and @ref EParseStatus::InvalidPayload, the begin pointer is
+   * incremented by the size of the MHAS packet, so parsing can continue with the next packet. On
+   * @ref EParseStatus::NeedMoreData, it is left unchanged. See @ref s_createPacket for
+   * @p payloadOwner and @p decoding.
+   *
+   * @note This function is not exception-free, see @ref s_createPacketWithStatus.
+   */
+  static SMhasParseResult s_parseNextPacketWithStatus(
+      const uint8_t*& begin, const uint8_t* end, bool audioPreRollPresent,
+      const std::shared_ptr<const uint8_t>& payloadOwner = nullptr,
+      EPayloadDecoding decoding = EPayloadDecoding::Eager);
+
+  /*!
+   * @brief Creates the MHAS packet of the appropriate child-type from an already decoded packet
+   * header and its payload and reports malformed input by status.
+   *
+   * See @ref s_createPacket for the parameters. The result status is either @ref EParseStatus::Ok
+   * or @ref EParseStatus::InvalidPayload.
+   *
+   * @note This function is not exception-free and cannot be used in builds with exceptions
+   * disabled. All other packet types are validated upfront, but config and ASI payloads are
+   * decoded by the bit parsers of mmtaudioparser, which signal errors by exceptions. With @ref
+   * EPayloadDecoding::Eager, these are caught here and reported as @ref
+   * EParseStatus::InvalidPayload. With @ref EPayloadDecoding::Lazy, no decoding takes place here,
+   * but decoding errors are thrown once the decoded structure is accessed. Failing memory
+   * allocations are thrown in either case.
+   */
+  static SMhasParseResult s_createPacketWithStatus(
+      const SMhasPacketHeader& header, const uint8_t* payload, bool audioPreRollPresent,
+      const std::shared_ptr<const uint8_t>& payloadOwner = nullptr,
+      EPayloadDecoding decoding = EPayloadDecoding::Eager, CMhasPacketPool* pool = nullptr);
+
+  /*!
+   * @brief Returns whether the given payload passes the validation of the packet type given in
+   * @p header, without throwing.
+   *
+   * The payloads of config and ASI packets are only checked to be non-empty.
+   */
+  static bool s_isValidPayload(const SMhasPacketHeader& header, const uint8_t* payload,
+                               bool audioPreRollPresent);
+
   /*!
    * @brief Sets the payload buffer to the given byte range.
    *
@@ -174,6 +445,24 @@ class CMhasPacket {
   //! Returns a copy to the internal payload buffer.
   virtual ilo::ByteBuffer payload() const;
 
+  /*!
+   * @brief Returns a view of this packet's payload without copying it.
+   *
+   * The view is valid until the payload of this packet is modified or the packet is destroyed.
+   */
+  SByteSpan payloadSpan() const;
+
+  //! Returns whether the payload is a view into the input chunk this packet was parsed from.
+  bool isPayloadShared() const;
+
+  /*!
+   * @brief Copies a shared payload into storage owned by this packet.
+   *
+   * This releases the reference to the input chunk the packet was parsed from. Setting a new
+   * payload implicitly does the same.
+   */
+  void materializePayload();
+
   /*!
    * @see EMhasPacketType
    * @returns this packet's type.
@@ -189,6 +478,11 @@ class CMhasPacket {
   //! Returns the CRC16 checksum of this packet's payload.
   uint16_t calculateCRC16() const;
 
+  //! Returns the result of the CRC16 verification done by the parser.
+  ECrcStatus crcStatus() const;
+  //! Sets the result of the CRC16 verification of this packet.
+  void crcStatus(ECrcStatus status);
+
   /*!
    * @param [in] dumpPayload - if set, also includes the payload bytes in the returned string.
    * @returns a string representation of this packet.
@@ -226,14 +520,43 @@ class CMhasPacket {
   //! Returns additional information about this packet
   virtual std::string packetSpecificInfo() const { return ""; }
 
+  // Recycles the payload buffers of its packets
+  friend class CMhasPacketPool;
+
  protected:
-  //! The raw payload buffer of this packet
+  //! The raw payload buffer of this packet, unused while the payload is shared
   ilo::ByteBuffer m_payload;
   //! The packet label
   uint64_t m_packetLabel;
 
  private:
+  void initPayload(const uint8_t* payload, std::size_t payloadLength,
+                   std::shared_ptr<const uint8_t> payloadOwner);
+  // Copies a payload referenced without ownership into the own buffer
+  void materializeBorrowedPayload();
+
   uint32_t m_packetType;
+  ECrcStatus m_crcStatus = ECrcStatus::NotVerified;
+  // Keeps the input chunk of a shared payload alive. A borrowed payload is referenced by an alias
+  // without ownership, i.e. with a use count of 0.
+  std::shared_ptr<const uint8_t> m_payloadOwner;
+  SByteSpan m_sharedPayload;
+};
+
+//! Result of the MHAS packet parse functions which report malformed input by status: either a
+//! packet or an error status
+struct SMhasParseResult {
+  //! The parse status, @ref packet is only set on @ref EParseStatus::Ok
+  EParseStatus status = EParseStatus::NeedMoreData;
+  //! The decoded packet header, valid unless the status is @ref EParseStatus::NeedMoreData
+  SMhasPacketHeader header;
+  //! The parsed MHAS packet
+  CUniqueMhasPacket packet;
+
+  //! Returns whether a packet was parsed successfully.
+  bool ok() const { return status == EParseStatus::Ok; }
+  //! Returns whether a packet was parsed successfully.
+  explicit operator bool() const { return ok(); }
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
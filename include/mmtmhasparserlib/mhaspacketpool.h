@@ -0,0 +1,219 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhaspacketpool.h
+ *
+ * @brief Pool recycling MHAS packet objects and payload buffers
+ */
+#pragma once
+
+// System includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "version.h"
+#include "mhasmemoryresource.h"
+#include "mhaspacket.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Pool recycling the memory of MHAS packets.
+ *
+ * Packets created by the pool are returned to it by the deleter of @ref CUniqueMhasPacket. The
+ * memory of the packet object and, for packets with owned payload storage, the payload buffer
+ * including its capacity are kept per packet type and reused for the next packet of that type. At
+ * steady state, parsing therefore does not allocate. Frame, sync, marker, CRC16 and generic
+ * packets reuse payload capacity, config, ASI and truncation packets only reuse the packet object.
+ *
+ * Packets keep the pool alive and may be released on any thread.
+ */
+class CMhasPacketPool : public std::enable_shared_from_this<CMhasPacketPool> {
+ public:
+  //! Default number of released packets kept per packet type
+  static const std::size_t DEFAULT_MAX_POOLED_PER_TYPE;
+
+  //! Usage statistics of the pool
+  struct SStatistics {
+    //! Number of packets created by the pool which have not been released yet
+    uint64_t packetsInUse = 0;
+    //! Maximum number of packets in use at the same time since creation or the last @ref trim
+    uint64_t packetsInUseHighWater = 0;
+    //! Number of released packet objects kept for reuse
+    uint64_t pooledPackets = 0;
+    //! Number of released payload buffers kept for reuse
+    uint64_t pooledPayloadBuffers = 0;
+    //! Total capacity in bytes of the released payload buffers kept for reuse
+    uint64_t pooledPayloadCapacity = 0;
+    //! Number of packet objects which had to be allocated because none was pooled
+    uint64_t packetAllocations = 0;
+    //! Number of packets created from a pooled packet object
+    uint64_t packetReuses = 0;
+  };
+
+  /*!
+   * @brief Creates a new packet pool.
+   *
+   * At most @p maxPooledPerType released packets (and payload buffers) are kept per packet type,
+   * further ones are freed. Packet objects are allocated from @p memoryResource, or from the
+   * default resource if none is given. The resource is only accessed while the pool is locked.
+   */
+  static std::shared_ptr<CMhasPacketPool> s_create(
+      std::size_t maxPooledPerType = DEFAULT_MAX_POOLED_PER_TYPE,
+      std::shared_ptr<CMhasMemoryResource> memoryResource = nullptr);
+
+  CMhasPacketPool(const CMhasPacketPool&) = delete;
+  CMhasPacketPool& operator=(const CMhasPacketPool&) = delete;
+  ~CMhasPacketPool();
+
+  /*!
+   * @brief Creates a pooled packet from an already decoded packet header and its payload.
+   *
+   * The parameters are the same as for @ref CMhasPacket::s_createPacket.
+   */
+  CUniqueMhasPacket createPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                 bool audioPreRollPresent,
+                                 const std::shared_ptr<const uint8_t>& payloadOwner = nullptr,
+                                 EPayloadDecoding decoding = EPayloadDecoding::Eager);
+
+  //! Returns the usage statistics of the pool.
+  SStatistics statistics() const;
+
+  /*!
+   * @brief Frees released packets and payload buffers until at most @p maxPooledPerType are kept
+   * per packet type.
+   *
+   * Also resets the high-water mark of the packets in use to the current number of packets in use.
+   */
+  void trim(std::size_t maxPooledPerType = 0);
+
+ private:
+  // Returns released packets to the pool
+  friend class CMhasPacketDeleter;
+
+  // Packet classes with separate storage, as their objects differ in size
+  enum ESlot : uint32_t {
+    Generic,
+    Config,
+    Frame,
+    Asi,
+    Sync,
+    Marker,
+    Crc16,
+    Truncation,
+    SlotCount
+  };
+
+  struct SSlot {
+    std::vector<void*> blocks;
+    std::vector<ilo::ByteBuffer> buffers;
+  };
+
+  CMhasPacketPool(std::size_t maxPooledPerType,
+                  std::shared_ptr<CMhasMemoryResource> memoryResource);
+
+  template <typename TPacket, typename... TArgs>
+  CUniqueMhasPacket construct(ESlot slot, ilo::ByteBuffer* payloadBuffer, TArgs&&... args);
+  // Takes a packet block and, if requested, a payload buffer from the pool under a single lock
+  void* acquire(ESlot slot, ilo::ByteBuffer* payloadBuffer);
+  // Returns a packet block and its payload buffer to the pool under a single lock
+  void recycle(ESlot slot, void* block, ilo::ByteBuffer payloadBuffer) noexcept;
+  static std::size_t s_blockSize(ESlot slot);
+  void release(CMhasPacket* packet, uint32_t slot) noexcept;
+
+  const std::size_t m_maxPooledPerType;
+  const std::shared_ptr<CMhasMemoryResource> m_memoryResource;
+  mutable std::mutex m_mutex;
+  std::array<SSlot, SlotCount> m_slots;
+  SStatistics m_statistics;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -0,0 +1,160 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhaspacketqueue.h
+ *
+ * @brief Bounded lock-free queue passing MHAS packets between two threads
+ */
+#pragma once
+
+// System includes
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Internal includes
+#include "version.h"
+#include "mhaspacket.h"
+
+namespace mmt {
+namespace mhasparserlib {
+/*!
+ * @brief Bounded single-producer/single-consumer ring buffer of MHAS packets.
+ *
+ * One thread pushes packets (e.g. the parser, see @ref CMhasParser::outputQueue) while another
+ * thread pops them, without any locks. Neither side allocates, and a full queue is reported to the
+ * producer instead of growing the queue, which bounds the memory held by parsed packets.
+ *
+ * @ref tryPush must only be called by the producer thread and @ref tryPop only by the consumer
+ * thread.
+ */
+class CMhasPacketQueue {
+ public:
+  /*!
+   * @brief Creates an empty queue holding at least @p capacity packets.
+   *
+   * The capacity is rounded up to the next power of two.
+   */
+  explicit CMhasPacketQueue(std::size_t capacity);
+  CMhasPacketQueue(const CMhasPacketQueue&) = delete;
+  CMhasPacketQueue& operator=(const CMhasPacketQueue&) = delete;
+
+  /*!
+   * @brief Appends the given packet to the end of the queue.
+   *
+   * @returns false if the queue is full, in which case @p packet is left untouched.
+   */
+  bool tryPush(CUniqueMhasPacket& packet);
+
+  //! Removes and returns the packet at the front of the queue, or NULL if the queue is empty.
+  CUniqueMhasPacket tryPop();
+
+  //! Returns the number of queued packets, which may already be outdated if called by one side
+  //! while the other side is active.
+  std::size_t size() const;
+
+  //! Returns whether no packets are queued, with the same limitations as @ref size.
+  bool empty() const { return size() == 0; }
+
+  //! Returns the maximum number of queued packets.
+  std::size_t capacity() const { return m_slots.size(); }
+
+ private:
+  // Keeps the positions written by producer and consumer on separate cache lines
+  static const std::size_t CACHE_LINE_SIZE = 64;
+
+  // State written by one side only, each on its own cache line
+  struct alignas(CACHE_LINE_SIZE) SPosition {
+    // Position of the next packet to pop (consumer) or push (producer)
+    std::atomic<std::size_t> position{0};
+    // Last position of the other side seen, saves loads of its cache line
+    std::size_t cachedOther = 0;
+  };
+
+  std::vector<CUniqueMhasPacket> m_slots;
+  const std::size_t m_mask;
+  SPosition m_consumer;
+  SPosition m_producer;
+};
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -88,20 +88,103 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <array>
 #include <cinttypes>
+#include <functional>
+#include <memory>
+#include <vector>
 
 // External includes
 #include "ilo/common_types.h"
 
 // Project includes
 #include "version.h"
+#include "mhasinputbuffer.h"
 #include "mhaspacket.h"
 
 namespace mmt {
 namespace mhasparserlib {
+class CMhasConfigPacket;
+class CMhasPacketQueue;
+
+/*!
+ * @brief Callback receiving borrowed MHAS packets from @ref CMhasParser::parsePackets.
+ *
+ * The packet is only valid for the duration of the call.
+ */
+using CPacketHandler = std::function<void(const CMhasPacket& packet)>;
+
+//! Strategies of an unsynchronized @ref CMhasParser to lock on the MHAS stream
+enum class ESyncStrategy {
+  //! Lock on MHAS sync packets only
+  SyncPacket,
+  //! Additionally lock on a chain of consecutive MHAS packet headers which follow each other
+  //! consistently, without waiting for the next MHAS sync packet. MHAS sync packets are only
+  //! accepted if they are followed by consistent packet headers as well.
+  HeaderChain
+};
+
+//! Describes how a @ref CMhasParser reached the "synchronized" state
+enum class ESyncSource {
+  //! The parser is not synchronized
+  None,
+  //! The parser was synchronized explicitly by calling @ref CMhasParser::sync
+  Explicit,
+  //! The parser locked on an MHAS sync packet
+  SyncPacket,
+  //! The parser locked on a chain of consistent MHAS packet headers
+  HeaderChain
+};
+
+//! Ways of a @ref CMhasParser to handle corrupted MHAS packets
+enum class EErrorHandling {
+  //! Errors are thrown as exceptions out of @ref CMhasParser::parsePackets
+  Strict,
+  //! Corrupted packets are dropped and counted, parsing continues with the next valid packet
+  Resilient
+};
+
+//! Counters of the errors handled by a @ref CMhasParser in @ref EErrorHandling::Resilient mode
+struct SMhasParserErrorCounters {
+  //! Number of implausible MHAS packet headers, each of which caused a loss of synchronization
+  uint64_t implausibleHeaders = 0;
+  //! Number of MHAS packets dropped because their payload could not be parsed
+  uint64_t invalidPayloads = 0;
+  //! Number of input bytes dropped while resynchronizing after a loss of synchronization
+  uint64_t skippedBytes = 0;
+};
+
+//! Counters of the CRC16 verifications done by a @ref CMhasParser (see @ref
+//! CMhasParser::crcVerification)
+struct SMhasCrcCounters {
+  //! Number of frame packets whose CRC matched the preceding MHAS CRC16 packet
+  uint64_t passed = 0;
+  //! Number of frame packets whose CRC did not match the preceding MHAS CRC16 packet
+  uint64_t failed = 0;
+  //! Number of frame packets which were not preceded by an MHAS CRC16 packet with the same label
+  uint64_t unprotected = 0;
+};
+
 //! Main MHAS parser.
 class CMhasParser {
  public:
+  //! Default number of consecutive MHAS packet headers required by @ref ESyncStrategy::HeaderChain
+  static const uint32_t DEFAULT_HEADER_CHAIN_LENGTH;
+
+  //! Creates a parser with an input buffer of the default capacity.
+  CMhasParser();
+  /*!
+   * @brief Creates a parser with an input buffer of the given capacity in bytes.
+   *
+   * The input buffer grows if more bytes are fed than it can hold, so the capacity should be chosen
+   * large enough to hold the maximum amount of pending input to avoid reallocations.
+   *
+   * The input buffer is allocated from @p memoryResource, or from the default resource if none is
+   * given. Packets with @ref EPayloadStorage::Shared payloads reference this memory.
+   */
+  explicit CMhasParser(std::size_t inputBufferCapacity,
+                       std::shared_ptr<CMhasMemoryResource> memoryResource = nullptr);
+
   //! Append the given binary buffer to the internal input buffer to be parsed on the next call to
   //! @ref parsePackets.
   void feed(const ilo::ByteBuffer& vector);
@@ -113,6 +196,132 @@ class CMhasParser {
    * this function returned.
    */
   void feed(const uint8_t* rawBuffer, size_t size);
+  /*!
+   * @brief Lends the given caller-owned buffer to the parser to be parsed on the next call to @ref
+   * parsePackets without copying it into the internal input buffer.
+   *
+   * MHAS packets are parsed straight out of the lent buffer. Only its unconsumed tail (an
+   * incomplete MHAS packet) is copied into the internal input buffer, after which the parser drops
+   * its reference to @p data. This happens at the latest when @ref parsePackets or @ref reset
+   * returns, so a custom deleter of @p data can be used as release callback to recycle the buffer.
+   * With @ref EPayloadStorage::Shared, the parsed packets keep their own references to @p data.
+   *
+   * @note The lent buffer must not be modified while the parser holds a reference to it.
+   */
+  void feed(std::shared_ptr<const uint8_t> data, std::size_t size);
+
+  /*!
+   * @brief Sets how the payload of parsed MHAS packets is stored.
+   *
+   * With @ref EPayloadStorage::Shared, packets reference the input chunk they were parsed from
+   * instead of copying their payload. Storage of the internal input buffer is then only reused once
+   * all packets referencing it have been destroyed or have materialized their payload (see @ref
+   * CMhasPacket::materializePayload), which may happen on any thread. Defaults to @ref
+   * EPayloadStorage::Owned.
+   */
+  void payloadStorage(EPayloadStorage storage);
+  //! Returns how the payload of parsed MHAS packets is stored.
+  EPayloadStorage payloadStorage() const;
+
+  /*!
+   * @brief Sets when parsed config and ASI packets decode their payload.
+   *
+   * With @ref EPayloadDecoding::Lazy, pass-through consumers never pay for decoding config and ASI
+   * packets. The parser itself only decodes a config packet if its payload differs from the
+   * previous config, as it needs to know whether audio pre-roll is present. Defaults to @ref
+   * EPayloadDecoding::Eager.
+   */
+  void payloadDecoding(EPayloadDecoding decoding);
+  //! Returns when parsed config and ASI packets decode their payload.
+  EPayloadDecoding payloadDecoding() const;
+
+  /*!
+   * @brief Sets the MHAS packet types returned by the parser.
+   *
+   * Packets of unsubscribed types are skipped by their length without being created, so neither
+   * memory is allocated nor is their payload copied or decoded. Config packets are still evaluated
+   * internally if their payload changed, as the parser needs to know whether audio pre-roll is
+   * present. By default, all packet types are subscribed.
+   */
+  void subscriptionMask(const CMhasPacketTypeMask& mask);
+  //! Returns the MHAS packet types returned by the parser.
+  const CMhasPacketTypeMask& subscriptionMask() const;
+
+  /*!
+   * @brief Sets the pool the packets returned by @ref nextPacket are created by.
+   *
+   * Pooled packets return their memory and payload capacity to the pool once they are destroyed.
+   * Frame, sync, marker, CRC16 and other generic packets are therefore created without allocations
+   * at steady state. Config, ASI and truncation packets only reuse the packet object and still
+   * allocate their decoded content. A pool may be shared by several parsers. By default
+   * (nullptr), every packet is allocated individually.
+   */
+  void packetPool(std::shared_ptr<CMhasPacketPool> pool);
+  //! Returns the pool the packets returned by @ref nextPacket are created by.
+  const std::shared_ptr<CMhasPacketPool>& packetPool() const;
+
+  /*!
+   * @brief Sets the queue parsed MHAS packets are pushed to instead of the output packet buffer.
+   *
+   * This allows another thread to pop the parsed packets without any locking, see
+   * @ref CMhasPacketQueue. If the queue is full, @ref parsePackets stops parsing and keeps the
+   * remaining input pending until the next call (see @ref isOutputBlocked). By default (nullptr),
+   * parsed packets are appended to the output packet buffer.
+   */
+  void outputQueue(std::shared_ptr<CMhasPacketQueue> queue);
+  //! Returns the queue parsed MHAS packets are pushed to.
+  const std::shared_ptr<CMhasPacketQueue>& outputQueue() const;
+
+  /*!
+   * @brief Returns whether the last call to @ref parsePackets stopped parsing because the output
+   * queue was full.
+   *
+   * The packet which did not fit is pushed first on the next call to @ref parsePackets.
+   */
+  bool isOutputBlocked() const;
+
+  /*!
+   * @brief Sets how @ref parsePackets handles corrupted MHAS packets.
+   *
+   * With @ref EErrorHandling::Resilient, a packet whose payload cannot be parsed is dropped while
+   * parsing continues with the following packet. An implausible packet header, i.e. one whose
+   * payload length contradicts the fixed payload length of its packet type, makes the parser lose
+   * synchronization (see @ref isSynced), in which case it resynchronizes on the remaining input
+   * according to the configured @ref syncStrategy instead of discarding it. Both cases are counted
+   * in @ref errorCounters. Packets of unknown types are skipped by their length as usual.
+   *
+   * A corrupted payload length may also point beyond the available input, in which case the parser
+   * would wait for the missing bytes. While a packet is incomplete, its header is therefore treated
+   * as implausible as well if it is atypical (e.g. its payload length exceeds 1 MiB) or if a sync
+   * packet followed by a consistent header chain is found within its declared payload. Defaults to
+   * @ref EErrorHandling::Strict.
+   */
+  void errorHandling(EErrorHandling errorHandling);
+  //! Returns how @ref parsePackets handles corrupted MHAS packets.
+  EErrorHandling errorHandling() const;
+  //! Returns the errors handled since construction or the last call to @ref resetErrorCounters.
+  const SMhasParserErrorCounters& errorCounters() const;
+  //! Resets all @ref errorCounters to zero.
+  void resetErrorCounters();
+
+  /*!
+   * @brief Enables the CRC16 verification of parsed MHAS packets.
+   *
+   * If enabled, each MHAS CRC16 packet is paired with the next MHAS frame packet with the same
+   * label, whose payload CRC is calculated in place before the packet is created. The result is
+   * stored in the frame packet (see @ref CMhasPacket::crcStatus) and counted in @ref crcCounters.
+   * MHAS CRC16 packets are evaluated even if they are not subscribed (see @ref subscriptionMask),
+   * while unsubscribed frames consume their CRC16 packet without being verified. Verifying does
+   * not allocate memory. Defaults to false.
+   */
+  void crcVerification(bool enabled);
+  //! Returns whether the CRC16 verification of parsed MHAS packets is enabled.
+  bool crcVerification() const;
+  //! Returns the CRC16 verifications done since construction or the last call to @ref
+  //! resetCrcCounters.
+  const SMhasCrcCounters& crcCounters() const;
+  //! Resets all @ref crcCounters to zero.
+  void resetCrcCounters();
 
   //! Returns the number of output MHAS packets available.
   uint32_t numPacketsAvailable() const;
@@ -120,16 +329,37 @@ class CMhasParser {
   //! parsePackets.
   uint32_t numBytesPending() const;
 
+  /*!
+   * @brief Sets the strategy used by @ref parsePackets to synchronize on the input stream.
+   *
+   * With @ref ESyncStrategy::HeaderChain, the parser additionally locks on the first position at
+   * which @p headerChainLength consecutive MHAS packet headers are plausible, belong to the same
+   * audio stream and each start right after the previous packet. This avoids waiting for the next
+   * MHAS sync packet when tuning into a stream. Longer chains reduce the risk of locking on random
+   * data at the cost of tune-in latency. Defaults to @ref ESyncStrategy::SyncPacket.
+   */
+  void syncStrategy(ESyncStrategy strategy,
+                    uint32_t headerChainLength = DEFAULT_HEADER_CHAIN_LENGTH);
+  //! Returns the strategy used by @ref parsePackets to synchronize on the input stream.
+  ESyncStrategy syncStrategy() const;
+  //! Returns the number of consecutive MHAS packet headers required by @ref
+  //! ESyncStrategy::HeaderChain.
+  uint32_t headerChainLength() const;
+
   /*!
    * @brief Returns whether the parser is synchronized.
    *
    * @ref parsePackets will drop all MHAS packets until it reaches the "synchronized" state, which
-   * can be achieved either by explicitly calling @ref sync or by parsing the first MHAS sync packet
-   * in calls to @ref parsePackets.
+   * can be achieved either by explicitly calling @ref sync or by locking on the input stream in
+   * calls to @ref parsePackets according to the configured @ref syncStrategy.
    *
-   * Once synchronized, the parser stays in that state until @ref reset is called.
+   * Once synchronized, the parser stays in that state until @ref reset is called or, with @ref
+   * EErrorHandling::Resilient, until it encounters an implausible MHAS packet header.
    */
   bool isSynced() const;
+  //! Returns how the parser reached the "synchronized" state or @ref ESyncSource::None if it is not
+  //! synchronized.
+  ESyncSource syncSource() const;
 
   /*!
    * @brief Mark the parser as "synchronized".
@@ -152,13 +382,31 @@ class CMhasParser {
    *
    * When called in an "unsynchronized" state (see @ref isSynced), all packets up until the first
    * MHAS sync packet will be dropped, resulting in the MHAS sync packet to be the first parsed
-   * packet. Immediate return of MHAS packets can be activated by calling @ref sync before calling
-   * this function.
+   * packet. With @ref ESyncStrategy::HeaderChain, the first parsed packet may also be the first
+   * packet of a consistent header chain. Immediate return of MHAS packets can be activated by
+   * calling @ref sync before calling this function.
    *
-   * The parsed packets can be retrieved by calling @ref nextPacket or @ref allAvailablePackets.
+   * The parsed packets can be retrieved by calling @ref nextPacket or @ref allAvailablePackets, or
+   * are pushed to the @ref outputQueue if one is set.
    */
   void parsePackets();
 
+  /*!
+   * @brief Parses as many MHAS packets as possible from the input byte buffer and passes them to
+   * the given handler in stream order.
+   *
+   * Packets are constructed on the stack instead of being allocated and queued. Packets still
+   * queued from previous calls to @ref parsePackets, including a packet held back by a full
+   * @ref outputQueue, are passed to the handler first. Apart from that, this function behaves
+   * like @ref parsePackets.
+   *
+   * @note The packet passed to @p handler is borrowed: it and its payload are only valid for the
+   * duration of the call. Copies of the packet stay valid, they either keep the input chunk alive
+   * (@ref EPayloadStorage::Shared) or copy the payload. @p handler must not call any function of
+   * this parser.
+   */
+  void parsePackets(const CPacketHandler& handler);
+
   /*!
    * @brief Returns the next MHAS packet in the output packet buffer or NULL if there are no pending
    * output packets.
@@ -175,15 +423,146 @@ class CMhasParser {
   CPacketDeque allAvailablePackets();
 
  private:
-  // If the current instance is not synced, this method will search for a sync packet in the given
-  // buffer. It will update the begin iterator to point at the first byte of the sync packet if
-  // found. Otherwise, begin will point to end.
-  bool syncIfNecessary(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  // If the current instance is not synced, this method will search for a sync packet (or a
+  // consistent header chain, depending on the sync strategy) in the input buffer. All bytes in
+  // front of the lock position are consumed from the input buffer.
+  bool syncIfNecessary();
 
-  bool m_isSynced = false;
-  ilo::ByteBuffer m_buffer;
+  // Continues the search for a lock position in the given linearized window at the front of the
+  // input buffer, which holds @p bufferedSize bytes. Returns false once the search needs bytes
+  // behind the window.
+  bool searchLockPosition(const uint8_t* begin, const uint8_t* end, std::size_t bufferedSize);
+
+  // Remembers a position whose header chain needs at least @p requiredSize bytes to be verified.
+  void addPendingSyncPosition(std::size_t offset, std::size_t requiredSize);
+
+  // Discards the state of an ongoing search for a lock position.
+  void resetSyncSearch();
+
+  // Parses all complete MHAS packets from the internal input buffer.
+  void parseBufferedPackets();
+
+  // Parses all complete MHAS packets from the lent buffer.
+  void parseLentPackets();
+
+  // Returns whether parsing can continue with the given header. In resilient mode, an implausible
+  // header makes the parser lose synchronization.
+  bool acceptHeader(const SMhasPacketHeader& header);
+  // Makes the parser lose synchronization because of an implausible header and counts it.
+  void rejectHeader();
+
+  // Returns whether parsing can wait for the rest of the incomplete MHAS packet at the front of the
+  // internal input buffer. In resilient mode, a packet whose length is most likely corrupted makes
+  // the parser lose synchronization.
+  bool acceptIncompletePacket();
+
+  // Consumes the given number of bytes from the internal input buffer.
+  void consumeBuffered(std::size_t size);
+
+  // Pairs the given frame packet with a preceding CRC16 packet and verifies its payload if the
+  // CRC16 verification is enabled. Skipped packets are not verified.
+  ECrcStatus verifyCrc(const SMhasPacketHeader& header, const uint8_t* payload, bool isSkipped);
+  void clearPendingCrcs();
+
+  // Creates the MHAS packet described by the given header and queues it or passes it to the
+  // packet handler.
+  void emitPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                  std::shared_ptr<const uint8_t> payloadOwner, ECrcStatus crcStatus);
+
+  // Creates the MHAS packet described by the given header. In resilient mode, an invalid packet is
+  // counted and NULL is returned instead of throwing.
+  CUniqueMhasPacket createPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                 const std::shared_ptr<const uint8_t>& payloadOwner);
+
+  // Constructs the MHAS packet described by the given header on the stack and passes it to the
+  // packet handler. In resilient mode, an invalid packet is counted instead of throwing.
+  void visitPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                   const std::shared_ptr<const uint8_t>& payloadOwner, ECrcStatus crcStatus);
+
+  // Passes the given packet to the packet handler after updating the internal state.
+  void handlePacket(const CMhasPacket& packet);
+
+  // Decodes the header of the next MHAS packet in the internal input buffer. Returns false if the
+  // header is incomplete.
+  bool decodeBufferedHeader(SMhasPacketHeader& header) const;
+
+  // Completes the MHAS packet at the end of the internal input buffer with bytes from the lent
+  // buffer and parses it. Returns false if the lent buffer does not contain enough bytes or if
+  // synchronization was lost.
+  bool completeBufferedPacket();
+
+  // Copies the remaining bytes of the lent buffer into the internal input buffer and releases it.
+  void copyLentBuffer();
+
+  // Returns whether the given packet neither needs to be returned nor evaluated internally.
+  bool canSkipPacket(const SMhasPacketHeader& header, const uint8_t* payload) const;
+
+  // Returns whether the given payload equals the config m_audioPreRollPresent was taken from.
+  bool isCurrentConfig(const SByteSpan& payload) const;
+
+  void addParsedPacket(CUniqueMhasPacket packet);
+  // Appends the packet to the output queue, or the output packet buffer if there is none
+  void outputPacket(CUniqueMhasPacket packet);
+
+  // Updates the audio pre-roll flag from the given config packet. Repeated configs are not decoded
+  // again.
+  void updateAudioPreRollPresent(const CMhasConfigPacket& configPacket);
+
+  ESyncSource m_syncSource = ESyncSource::None;
+  ESyncStrategy m_syncStrategy = ESyncStrategy::SyncPacket;
+  uint32_t m_headerChainLength = DEFAULT_HEADER_CHAIN_LENGTH;
+  EErrorHandling m_errorHandling = EErrorHandling::Strict;
+  SMhasParserErrorCounters m_errorCounters;
+  // Set while resynchronizing after a loss of synchronization
+  bool m_isResyncing = false;
+  // Bytes of the incomplete packet at the front of the input buffer already searched for a sync
+  // packet by acceptIncompletePacket
+  std::size_t m_incompleteScanOffset = 0;
+  // Offset in the input buffer at which the search for a lock position continues, or the lock
+  // position once it was found
+  std::size_t m_syncScanOffset = 0;
+  // Position in the input buffer whose header chain was incomplete
+  struct SPendingSyncPosition {
+    std::size_t offset;
+    // End offset of the bytes needed to continue verifying the header chain
+    std::size_t requiredEnd;
+  };
+  // Pending positions in ascending order
+  std::vector<SPendingSyncPosition> m_pendingSyncPositions;
+  CMhasInputBuffer m_buffer;
+  // Holds packets wrapping around the end of the input buffer while they are parsed
+  ilo::ByteBuffer m_wrappedPacket;
+  // Caller-owned buffer given to feed, parsed after the bytes in the internal input buffer
+  std::shared_ptr<const uint8_t> m_lentBuffer;
+  const uint8_t* m_lentBegin = nullptr;
+  const uint8_t* m_lentEnd = nullptr;
   CPacketDeque m_parsedPackets;
   bool m_audioPreRollPresent = false;
+  // Payload of the config packet m_audioPreRollPresent was taken from
+  ilo::ByteBuffer m_configPayload;
+  EPayloadStorage m_payloadStorage = EPayloadStorage::Owned;
+  EPayloadDecoding m_payloadDecoding = EPayloadDecoding::Eager;
+  CMhasPacketTypeMask m_subscriptionMask = CMhasPacketTypeMask().set();
+  std::shared_ptr<CMhasPacketPool> m_packetPool;
+  std::shared_ptr<CMhasPacketQueue> m_outputQueue;
+  // Parsed packet which did not fit into the full output queue
+  CUniqueMhasPacket m_blockedPacket;
+  // Set during parsePackets(handler) only
+  const CPacketHandler* m_packetHandler = nullptr;
+
+  // CRC16 packet waiting for the next packet with the same label
+  struct SPendingCrc {
+    uint64_t packetLabel = 0;
+    uint16_t crc = 0;
+    bool isValid = false;
+  };
+  // Number of labels with pending CRC16 packets, the oldest one is replaced if exceeded
+  static const std::size_t MAX_PENDING_CRCS = 8;
+
+  bool m_crcVerification = false;
+  SMhasCrcCounters m_crcCounters;
+  std::array<SPendingCrc, MAX_PENDING_CRCS> m_pendingCrcs;
+  std::size_t m_nextPendingCrc = 0;
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -88,6 +88,7 @@ amm-info@iis.fraunhofer.de
 #pragma once
 
 // System includes
+#include <memory>
 #include <string>
 
 // External includes
@@ -112,9 +113,24 @@ class CMhasSyncPacket final : public CMhasPacket {
    * The begin iterator is incremented by the number of bytes read to parse this MHAS packet.
    */
   CMhasSyncPacket(ilo::ByteBuffer::const_iterator& begin, ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the sync packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   *
+   * If @p payloadOwner is set, the payload is shared instead of copied (see @ref EPayloadStorage).
+   */
+  CMhasSyncPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                  std::shared_ptr<const uint8_t> payloadOwner = nullptr);
+
+  //! Returns whether the given payload is a valid sync packet payload, without throwing.
+  static bool s_isValidPayload(const SByteSpan& payload);
 
  protected:
   std::string packetName() const override;
+
+ private:
+  void initFromPayload();
 };
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -122,6 +122,12 @@ class CMhasTruncationPacket final : public CMhasPacket {
    */
   CMhasTruncationPacket(ilo::ByteBuffer::const_iterator& begin,
                         ilo::ByteBuffer::const_iterator end);
+  /*!
+   * @brief Initialize the truncation packet from an already decoded packet header and its payload.
+   *
+   * @p payload must point to the @p header.payloadLength bytes following the packet header.
+   */
+  CMhasTruncationPacket(const SMhasPacketHeader& header, const uint8_t* payload);
   //! Initializes the truncation packet with the given packet label and truncation configuration.
   CMhasTruncationPacket(uint64_t label, const SMhasTruncationPacketConfig& config);
 
@@ -150,6 +156,9 @@ class CMhasTruncationPacket final : public CMhasPacket {
    */
   void payload(ilo::ByteBuffer::const_iterator begin, ilo::ByteBuffer::const_iterator end) override;
 
+  //! Returns whether the given payload is a valid truncation packet payload, without throwing.
+  static bool s_isValidPayload(const SByteSpan& payload);
+
  protected:
   //! Returns the name of this MHAS packet type
   std::string packetName() const override;
@@ -158,6 +167,7 @@ class CMhasTruncationPacket final : public CMhasPacket {
   std::string packetSpecificInfo() const override;
 
  private:
+  void initFromPayload();
   SMhasTruncationPacketConfig parsePayload(ilo::ByteBuffer::const_iterator begin,
                                            ilo::ByteBuffer::const_iterator end);
   void applyConfig(const SMhasTruncationPacketConfig& config);
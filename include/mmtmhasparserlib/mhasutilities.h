@@ -87,6 +87,11 @@ amm-info@iis.fraunhofer.de
  */
 #pragma once
 
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
 // External includes
 #include "ilo/bitbuffer.h"
 #include "ilo/bitparser.h"
@@ -102,5 +107,193 @@ uint64_t readEscapedValue(ilo::CBitParser& bitParser, uint8_t first, uint8_t sec
 //! Writes an escaped value as defined in ISO/IEC 23003-3:2012, 5.2, Table 16.
 void writeEscapedValue(ilo::CBitBuffer& bitBuffer, uint64_t value, uint8_t first, uint8_t second,
                        uint8_t third);
+
+/*!
+ * @brief Copies @p numBits bits from @p source to @p dest at arbitrary bit offsets.
+ *
+ * Bits are numbered most significant bit first within each byte, like ilo::CBitParser and
+ * ilo::CBitBuffer do. Bits of @p dest outside of the copied range are preserved, and no bytes
+ * beyond the copied range are accessed. The byte ranges must not overlap.
+ */
+void copyBits(const uint8_t* source, std::size_t sourceBitOffset, uint8_t* dest,
+              std::size_t destBitOffset, std::size_t numBits);
+
+//! Returns the number of bits needed to write the given value as escaped value as defined in
+//! ISO/IEC 23003-3:2012, 5.2, Table 16.
+constexpr uint32_t escapedValueBits(uint64_t value, uint32_t first, uint32_t second,
+                                    uint32_t third) {
+  return value < (uint64_t{1} << first) - 1u ? first
+         : value - ((uint64_t{1} << first) - 1u) < (uint64_t{1} << second) - 1u
+             ? first + second
+             : first + second + third;
+}
+
+/*!
+ * @brief Escaped value format (ISO/IEC 23003-3:2012, 5.2, Table 16) with runtime bit widths.
+ *
+ * This is the single implementation of reading, writing and peeking escaped values, used by
+ * @ref readEscapedValue, @ref writeEscapedValue and @ref SEscapedValueCodec. The bit widths are
+ * not validated here and must not exceed 63.
+ */
+struct SEscapedValueFormat {
+  uint32_t first;
+  uint32_t second;
+  uint32_t third;
+
+  //! Returns the value of the first field which signals that the second field follows.
+  constexpr uint64_t firstEscape() const { return (uint64_t{1} << first) - 1u; }
+  //! Returns the value of the second field which signals that the third field follows.
+  constexpr uint64_t secondEscape() const { return (uint64_t{1} << second) - 1u; }
+
+  //! Returns the number of bits needed to write the given value.
+  constexpr uint32_t bits(uint64_t value) const {
+    return escapedValueBits(value, first, second, third);
+  }
+
+  //! Reads an escaped value.
+  uint64_t read(ilo::CBitParser& bitParser) const {
+    uint64_t value = bitParser.read<uint64_t>(first);
+    if (value == firstEscape()) {
+      const uint64_t valueAdd = bitParser.read<uint64_t>(second);
+      value += valueAdd;
+      if (valueAdd == secondEscape()) {
+        value += bitParser.read<uint64_t>(third);
+      }
+    }
+    return value;
+  }
+
+  //! Writes an escaped value. Throws std::invalid_argument if the value is too large.
+  void write(ilo::CBitBuffer& bitBuffer, uint64_t value) const {
+    if (value < firstEscape()) {
+      bitBuffer.write(value, first);
+      return;
+    }
+    bitBuffer.write(firstEscape(), first);
+    value -= firstEscape();
+
+    if (value < secondEscape()) {
+      bitBuffer.write(value, second);
+      return;
+    }
+    bitBuffer.write(secondEscape(), second);
+    value -= secondEscape();
+
+    s_checkThirdField(value, third);
+    bitBuffer.write(value, third);
+  }
+
+  /*!
+   * @brief Reads an escaped value from a raw byte range, starting at bit position @p bitPos.
+   *
+   * In contrast to @ref read this does not throw if the byte range is too short, but returns false
+   * instead. @p bitPos is advanced past the value on success.
+   */
+  bool peek(const uint8_t* data, std::size_t size, std::size_t& bitPos, uint64_t& value) const {
+    uint64_t valueAdd = 0;
+    if (!s_peekBits(data, size, bitPos, first, value)) {
+      return false;
+    }
+    if (value == firstEscape()) {
+      if (!s_peekBits(data, size, bitPos, second, valueAdd)) {
+        return false;
+      }
+      value += valueAdd;
+      if (valueAdd == secondEscape()) {
+        if (!s_peekBits(data, size, bitPos, third, valueAdd)) {
+          return false;
+        }
+        value += valueAdd;
+      }
+    }
+    return true;
+  }
+
+ private:
+  // Throws std::invalid_argument if the remainder does not fit into the third field
+  static void s_checkThirdField(uint64_t value, uint32_t third);
+
+  // Reads the given number of bits from a raw byte range. Returns false if it is too short.
+  static bool s_peekBits(const uint8_t* data, std::size_t size, std::size_t& bitPos, uint32_t bits,
+                         uint64_t& result) {
+    if (bitPos + bits > size * 8u) {
+      return false;
+    }
+    result = 0;
+    while (bits > 0u) {
+      const auto bitInByte = static_cast<uint32_t>(bitPos % 8u);
+      const uint32_t count = bits < 8u - bitInByte ? bits : 8u - bitInByte;
+      const uint32_t byte = data[bitPos / 8u];
+      result = (result << count) | ((byte >> (8u - bitInByte - count)) & ((1u << count) - 1u));
+      bitPos += count;
+      bits -= count;
+    }
+    return true;
+  }
+};
+
+/*!
+ * @brief Escaped value codec (ISO/IEC 23003-3:2012, 5.2, Table 16) with fixed bit widths.
+ *
+ * In contrast to @ref readEscapedValue and @ref writeEscapedValue, the bit widths are validated
+ * at compile time, so no range checks are needed per call. All calls are forwarded to
+ * @ref SEscapedValueFormat with constant widths. Use the function templates @ref readEscaped,
+ * @ref writeEscaped and @ref escapedBits for convenience.
+ */
+template <uint8_t First, uint8_t Second, uint8_t Third>
+struct SEscapedValueCodec {
+  static_assert(First > 0 && First <= 63, "Bit count for escaped value out of range.");
+  static_assert(Second <= 63, "Bit count for escaped value too large.");
+  static_assert(Third <= 63, "Bit count for escaped value too large.");
+
+  //! The value of the first field which signals that the second field follows
+  static constexpr uint64_t FIRST_ESCAPE = (uint64_t{1} << First) - 1u;
+  //! The value of the second field which signals that the third field follows
+  static constexpr uint64_t SECOND_ESCAPE = (uint64_t{1} << Second) - 1u;
+  //! The largest value which can be expressed with this codec
+  static constexpr uint64_t MAX_VALUE =
+      FIRST_ESCAPE + SECOND_ESCAPE + ((uint64_t{1} << Third) - 1u);
+  //! The largest number of bits an escaped value of this codec can occupy
+  static constexpr uint32_t MAX_BITS = uint32_t{First} + Second + Third;
+
+  //! Returns the format with the bit widths of this codec.
+  static constexpr SEscapedValueFormat format() {
+    return SEscapedValueFormat{First, Second, Third};
+  }
+
+  //! Returns the number of bits needed to write the given value.
+  static constexpr uint32_t bits(uint64_t value) { return format().bits(value); }
+
+  //! Reads an escaped value.
+  static uint64_t read(ilo::CBitParser& bitParser) { return format().read(bitParser); }
+
+  //! Writes an escaped value. Throws std::invalid_argument if the value is too large.
+  static void write(ilo::CBitBuffer& bitBuffer, uint64_t value) {
+    format().write(bitBuffer, value);
+  }
+
+  //! Reads an escaped value from a raw byte range, see SEscapedValueFormat::peek.
+  static bool peek(const uint8_t* data, std::size_t size, std::size_t& bitPos, uint64_t& value) {
+    return format().peek(data, size, bitPos, value);
+  }
+};
+
+//! Reads an escaped value with the bit widths given as template arguments.
+template <uint8_t First, uint8_t Second, uint8_t Third>
+inline uint64_t readEscaped(ilo::CBitParser& bitParser) {
+  return SEscapedValueCodec<First, Second, Third>::read(bitParser);
+}
+
+//! Writes an escaped value with the bit widths given as template arguments.
+template <uint8_t First, uint8_t Second, uint8_t Third>
+inline void writeEscaped(ilo::CBitBuffer& bitBuffer, uint64_t value) {
+  SEscapedValueCodec<First, Second, Third>::write(bitBuffer, value);
+}
+
+//! Returns the number of bits of an escaped value with the bit widths given as template arguments.
+template <uint8_t First, uint8_t Second, uint8_t Third>
+constexpr uint32_t escapedBits(uint64_t value) {
+  return SEscapedValueCodec<First, Second, Third>::bits(value);
+}
 }  // namespace mhasparserlib
 }  // namespace mmt
@@ -88,21 +88,64 @@ amm-info@iis.fraunhofer.de
 // Internal includes
 #include "logging.h"
 #include "mmtmhasparserlib/mhasasipacket.h"
+#include "mmtmhasparserlib/mhasdecodecache.h"
 
 using namespace mmt::mhasparserlib;
 
 CMhasAsiPacket::CMhasAsiPacket(ilo::ByteBuffer::const_iterator& begin,
                                ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload(EPayloadDecoding::Eager);
+}
+
+CMhasAsiPacket::CMhasAsiPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                               EPayloadDecoding decoding)
+    : CMhasPacket(header, payload) {
+  initFromPayload(decoding);
+}
+
+void CMhasAsiPacket::initFromPayload(EPayloadDecoding decoding) {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_AUDIOSCENEINFO,
                   std::invalid_argument, "Invalid packet type.");
-  auto payloadBeginIterator = m_payload.cbegin();
-  m_sceneInfo = SAudioSceneInfo();
-  m_sceneInfo.parsePayload(payloadBeginIterator, m_payload.end());
+  if (decoding == EPayloadDecoding::Eager) {
+    decodedSceneInfo();
+  }
+}
 
-  payloadBeginIterator = m_payload.end();
-  ILO_ASSERT_WITH(payloadBeginIterator == m_payload.end(), std::invalid_argument,
-                  "Payload was not completely parsed (contains data after ASI).");
+std::shared_ptr<const CMhasAsiPacket::SAudioSceneInfo> CMhasAsiPacket::decodedSceneInfo() const {
+  auto sceneInfo = std::atomic_load(&m_sceneInfo);
+  if (!sceneInfo) {
+    // Identical ASIs repeated with every IPF are only decoded once if caching is enabled
+    auto decoded = CMhasDecodeCache::s_global().intern<SAudioSceneInfo>(
+        packetType(), m_payload, [this]() {
+          auto payloadBeginIterator = m_payload.cbegin();
+          auto parsed = std::make_shared<SAudioSceneInfo>();
+          parsed->parsePayload(payloadBeginIterator, m_payload.end());
+
+          payloadBeginIterator = m_payload.end();
+          ILO_ASSERT_WITH(payloadBeginIterator == m_payload.end(), std::invalid_argument,
+                          "Payload was not completely parsed (contains data after ASI).");
+          return parsed;
+        });
+    // Concurrent first accesses may each decode, but all of them use the first stored result
+    sceneInfo = std::atomic_compare_exchange_strong(&m_sceneInfo, &sceneInfo, decoded)
+                    ? decoded
+                    : sceneInfo;
+  }
+  return sceneInfo;
+}
+
+const CMhasAsiPacket::SAudioSceneInfo& CMhasAsiPacket::audioSceneInfo() const {
+  return *decodedSceneInfo();
+}
+
+std::shared_ptr<const CMhasAsiPacket::SAudioSceneInfo> CMhasAsiPacket::audioSceneInfoSnapshot()
+    const {
+  return decodedSceneInfo();
+}
+
+bool CMhasAsiPacket::isDecoded() const {
+  return std::atomic_load(&m_sceneInfo) != nullptr;
 }
 
 CMhasAsiPacket::CMhasAsiPacket(uint64_t label, ilo::ByteBuffer::const_iterator payloadBegin,
@@ -115,10 +158,12 @@ CMhasAsiPacket::CMhasAsiPacket(uint64_t label, ilo::ByteBuffer::const_iterator p
 void CMhasAsiPacket::payload(ilo::ByteBuffer::const_iterator begin,
                              ilo::ByteBuffer::const_iterator end) {
   auto beginCopy = begin;
-  m_sceneInfo = SAudioSceneInfo();
-  m_sceneInfo.parsePayload(begin, end);
+  // Snapshots handed out before must not change
+  auto sceneInfo = std::make_shared<SAudioSceneInfo>();
+  sceneInfo->parsePayload(begin, end);
   ILO_ASSERT_WITH(begin == end, std::invalid_argument,
                   "Payload was not completely parsed (contains data after ASI).");
+  std::atomic_store(&m_sceneInfo, std::shared_ptr<const SAudioSceneInfo>(std::move(sceneInfo)));
 
   CMhasPacket::payload(beginCopy, end);
 }
@@ -254,21 +299,22 @@ void CMhasAsiPacket::SAudioSceneGroupPresets::parsePayload(ilo::CBitParser& bitp
     condition.onOff = bitparser.read<uint8_t>(1) == 1;
 
     if (condition.onOff) {
-      condition.condition = std::make_shared<
+      auto conditionInfo = std::make_shared<
           CMhasAsiPacket::SAudioSceneGroupPresets::SAudioScenePresetCondition::SCondition>();
-      condition.condition->disableGainInteractivity = bitparser.read<uint8_t>(1) == 1;
-      condition.condition->gainFlag = bitparser.read<uint8_t>(1) == 1;
-      if (condition.condition->gainFlag) {
-        condition.condition->gain = bitparser.read<uint8_t>(8);
+      conditionInfo->disableGainInteractivity = bitparser.read<uint8_t>(1) == 1;
+      conditionInfo->gainFlag = bitparser.read<uint8_t>(1) == 1;
+      if (conditionInfo->gainFlag) {
+        conditionInfo->gain = bitparser.read<uint8_t>(8);
       }
 
-      condition.condition->disablePositionInteractivity = bitparser.read<uint8_t>(1) == 1;
-      condition.condition->positionFlag = bitparser.read<uint8_t>(1) == 1;
-      if (condition.condition->positionFlag) {
-        condition.condition->azOffset = bitparser.read<uint8_t>(8);
-        condition.condition->elOffset = bitparser.read<uint8_t>(6);
-        condition.condition->distFactor = bitparser.read<uint8_t>(4);
+      conditionInfo->disablePositionInteractivity = bitparser.read<uint8_t>(1) == 1;
+      conditionInfo->positionFlag = bitparser.read<uint8_t>(1) == 1;
+      if (conditionInfo->positionFlag) {
+        conditionInfo->azOffset = bitparser.read<uint8_t>(8);
+        conditionInfo->elOffset = bitparser.read<uint8_t>(6);
+        conditionInfo->distFactor = bitparser.read<uint8_t>(4);
       }
+      condition.condition = conditionInfo;
     }
     return condition;
   });
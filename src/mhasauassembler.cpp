@@ -0,0 +1,240 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+// External includes
+#include "ilo/memory.h"
+
+// Internal includes
+#include "logging.h"
+#include "mmtmhasparserlib/mhasauassembler.h"
+
+using namespace mmt::mhasparserlib;
+
+static bool isSamePayload(const ilo::ByteBuffer& previous, const SByteSpan& payload) {
+  return !previous.empty() && previous.size() == payload.size &&
+         std::equal(payload.begin(), payload.end(), previous.begin());
+}
+
+CMhasAuAssembler::CMhasAuAssembler(uint32_t timescale) : m_timescale(timescale) {
+  ILO_ASSERT_WITH(timescale != 0, std::invalid_argument, "The timescale must not be zero");
+}
+
+uint32_t CMhasAuAssembler::timescale() const {
+  return m_timescale;
+}
+
+void CMhasAuAssembler::addPacket(CUniqueMhasPacket packet) {
+  ILO_ASSERT_WITH(packet != nullptr, std::invalid_argument, "No packet provided");
+
+  const uint64_t label = packet->packetLabel();
+  if (label == 0) {
+    m_unlabeledPackets.push_back(std::move(packet));
+    return;
+  }
+
+  SStreamState& stream = m_streams[label];
+  switch (static_cast<EMhasPacketType>(packet->packetType())) {
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
+      handleConfig(stream, dynamic_cast<const CMhasConfigPacket&>(*packet));
+      break;
+    case EMhasPacketType::PACTYP_AUDIOTRUNCATION: {
+      const auto& truncationPacket = dynamic_cast<const CMhasTruncationPacket&>(*packet);
+      stream.truncation.isActive = truncationPacket.isActive();
+      stream.truncation.truncateFromBegin = truncationPacket.truncateFromBegin();
+      stream.truncation.truncatedSamples = truncationPacket.truncatedSamples();
+      break;
+    }
+    default:
+      break;
+  }
+
+  // Unlabeled packets preceding this packet belong to the same access unit
+  stream.packets.insert(stream.packets.end(), std::make_move_iterator(m_unlabeledPackets.begin()),
+                        std::make_move_iterator(m_unlabeledPackets.end()));
+  m_unlabeledPackets.clear();
+
+  const bool isFrame =
+      packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME);
+  stream.packets.push_back(std::move(packet));
+
+  if (isFrame) {
+    completeAccessUnit(label, stream);
+  }
+}
+
+void CMhasAuAssembler::addPackets(CPacketDeque packets) {
+  for (auto& packet : packets) {
+    addPacket(std::move(packet));
+  }
+}
+
+uint32_t CMhasAuAssembler::numAccessUnitsAvailable() const {
+  return static_cast<uint32_t>(m_accessUnits.size());
+}
+
+CUniqueMhasAccessUnit CMhasAuAssembler::nextAccessUnit() {
+  if (m_accessUnits.empty()) {
+    return nullptr;
+  }
+
+  CUniqueMhasAccessUnit accessUnit = std::move(m_accessUnits.front());
+  m_accessUnits.pop_front();
+  return accessUnit;
+}
+
+void CMhasAuAssembler::reset() {
+  m_unlabeledPackets.clear();
+  m_streams.clear();
+  m_accessUnits.clear();
+}
+
+void CMhasAuAssembler::handleConfig(SStreamState& stream, const CMhasConfigPacket& configPacket) {
+  const SByteSpan payload = configPacket.payloadSpan();
+
+  // Repeated configs are not decoded again
+  if (isSamePayload(stream.configPayload, payload)) {
+    return;
+  }
+
+  const CMhasConfigPacket::SConfig& config = configPacket.mhasConfigInfo();
+  const uint32_t sampleRate = config.outputSamplingFrequency > 0
+                                  ? static_cast<uint32_t>(config.outputSamplingFrequency)
+                                  : 0u;
+  const uint32_t frameSize =
+      config.outputFramesize > 0 ? static_cast<uint32_t>(config.outputFramesize) : 0u;
+
+  if (sampleRate != stream.sampleRate || frameSize != stream.frameSize) {
+    // Restart the sample count so that the timestamps continue seamlessly in the new timing
+    stream.timingStart = currentTime(stream);
+    stream.samplesSinceTimingStart = 0;
+    stream.sampleRate = sampleRate;
+    stream.frameSize = frameSize;
+  }
+
+  stream.configPayload.assign(payload.begin(), payload.end());
+  stream.isConfigChanged = true;
+}
+
+void CMhasAuAssembler::completeAccessUnit(uint64_t label, SStreamState& stream) {
+  auto accessUnit = ilo::make_unique<SMhasAccessUnit>();
+  accessUnit->label = label;
+  accessUnit->packets = std::move(stream.packets);
+  stream.packets.clear();
+
+  accessUnit->hasTiming = stream.sampleRate != 0 && stream.frameSize != 0;
+  accessUnit->isConfigChanged = stream.isConfigChanged;
+  accessUnit->sampleRate = stream.sampleRate;
+  if (stream.truncation.isActive) {
+    accessUnit->truncatedSamples = stream.truncation.truncatedSamples;
+    accessUnit->truncateFromBegin = stream.truncation.truncateFromBegin;
+  }
+
+  accessUnit->ptsSamples = stream.ptsSamples;
+  accessUnit->pts = currentTime(stream);
+  if (accessUnit->hasTiming) {
+    accessUnit->durationSamples =
+        stream.frameSize - std::min(accessUnit->truncatedSamples, stream.frameSize);
+
+    stream.ptsSamples += accessUnit->durationSamples;
+    stream.samplesSinceTimingStart += accessUnit->durationSamples;
+    accessUnit->duration = currentTime(stream) - accessUnit->pts;
+  }
+
+  // Config changes and truncations only apply to the access unit they are part of
+  stream.isConfigChanged = false;
+  stream.truncation = CMhasTruncationPacket::SMhasTruncationPacketConfig{};
+
+  m_accessUnits.push_back(std::move(accessUnit));
+}
+
+uint64_t CMhasAuAssembler::currentTime(const SStreamState& stream) const {
+  if (stream.sampleRate == 0) {
+    return stream.timingStart;
+  }
+  return stream.timingStart + stream.samplesSinceTimingStart * m_timescale / stream.sampleRate;
+}
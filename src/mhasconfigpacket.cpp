@@ -91,6 +91,7 @@ amm-info@iis.fraunhofer.de
 // Internal includes
 #include "logging.h"
 #include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhasdecodecache.h"
 
 using namespace mmt::mhasparserlib;
 
@@ -103,11 +104,36 @@ static const std::map<int32_t, double> RESAMPLING_RATIOS{
 CMhasConfigPacket::CMhasConfigPacket(ilo::ByteBuffer::const_iterator& begin,
                                      ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload(EPayloadDecoding::Eager);
+}
+
+CMhasConfigPacket::CMhasConfigPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                     EPayloadDecoding decoding)
+    : CMhasPacket(header, payload) {
+  initFromPayload(decoding);
+}
+
+void CMhasConfigPacket::initFromPayload(EPayloadDecoding decoding) {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_MPEGH3DACFG,
                   std::invalid_argument, "Invalid packet type.");
-  ilo::ByteBuffer::const_iterator buffBeg = m_payload.begin();
-  ilo::ByteBuffer::const_iterator buffEnd = m_payload.end();
-  m_config.parsePayload(buffBeg, buffEnd);
+  if (decoding == EPayloadDecoding::Eager) {
+    decodedConfig();
+  }
+}
+
+std::shared_ptr<const CMhasConfigPacket::SConfig> CMhasConfigPacket::decodedConfig() const {
+  auto config = std::atomic_load(&m_config);
+  if (!config) {
+    // Identical configs repeated with every IPF are only decoded once if caching is enabled
+    auto decoded = CMhasDecodeCache::s_global().intern<SConfig>(packetType(), m_payload, [this]() {
+      auto parsed = std::make_shared<SConfig>();
+      parsed->parsePayload(m_payload.begin(), m_payload.end());
+      return parsed;
+    });
+    // Concurrent first accesses may each decode, but all of them use the first stored result
+    config = std::atomic_compare_exchange_strong(&m_config, &config, decoded) ? decoded : config;
+  }
+  return config;
 }
 
 CMhasConfigPacket::CMhasConfigPacket(uint64_t label, ilo::ByteBuffer::const_iterator payloadStart,
@@ -161,32 +187,31 @@ void CMhasConfigPacket::SConfig::parsePayload(ilo::ByteBuffer::const_iterator be
     outputFramesize = static_cast<int32_t>(coreFrameLength * ratioIt->second);
   }
 
-  referenceLayout = std::make_shared<SSpeakerConfig3d>();
+  auto layout = std::make_shared<SSpeakerConfig3d>();
 
   switch (configInfo.referenceLayout.speakerLayoutType) {
     case 0:
-      referenceLayout->speakerLayoutType =
-          SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERLAYOUTIDX;
+      layout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERLAYOUTIDX;
       break;
     case 1:
-      referenceLayout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERIDX;
+      layout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERIDX;
       break;
     case 2:
-      referenceLayout->speakerLayoutType =
-          SSpeakerConfig3d::ESpeakerLayoutType::FLEXIBLESPEAKERCONFIG;
+      layout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::FLEXIBLESPEAKERCONFIG;
       break;
     case 3:
-      referenceLayout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CONTRIBUTIONMODE;
+      layout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CONTRIBUTIONMODE;
       break;
     default:
-      referenceLayout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::INVALID;
+      layout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::INVALID;
       ILO_ASSERT(false, "Invalid speaker layout type found.");
       break;
   }
 
-  referenceLayout->cicpSpeakerLayoutIdx = configInfo.referenceLayout.CICPIdx;
-  referenceLayout->cicpSpeakerIdx = configInfo.referenceLayout.CICPSpeakerIdx;
-  referenceLayout->numSpeakers = configInfo.referenceLayout.numSpeakers;
+  layout->cicpSpeakerLayoutIdx = configInfo.referenceLayout.CICPIdx;
+  layout->cicpSpeakerIdx = configInfo.referenceLayout.CICPSpeakerIdx;
+  layout->numSpeakers = configInfo.referenceLayout.numSpeakers;
+  referenceLayout = layout;
 
   for (size_t grp = 0; grp < configInfo.signalGroups.size(); grp++) {
     std::shared_ptr<SSignals3d::SSignalGroup> signalGroup =
@@ -195,42 +220,41 @@ void CMhasConfigPacket::SConfig::parsePayload(ilo::ByteBuffer::const_iterator be
     signalGroup->numSignals = configInfo.signalGroups[grp].numSignals;
 
     switch (configInfo.signalGroups[grp].signalGroupType) {
-      case 0:
+      case 0: {
         signalGroup->signalGroupType = SSignals3d::SSignalGroup::ESignalGroupType::CHANNELS;
 
-        signalGroup->audioChannelLayout = std::make_shared<SSpeakerConfig3d>();
+        auto channelLayout = std::make_shared<SSpeakerConfig3d>();
 
         switch (configInfo.signalGroups[grp].audioChannelLayout.speakerLayoutType) {
           case 0:
-            signalGroup->audioChannelLayout->speakerLayoutType =
+            channelLayout->speakerLayoutType =
                 SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERLAYOUTIDX;
             break;
           case 1:
-            signalGroup->audioChannelLayout->speakerLayoutType =
-                SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERIDX;
+            channelLayout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::CICPSPEAKERIDX;
             break;
           case 2:
-            signalGroup->audioChannelLayout->speakerLayoutType =
+            channelLayout->speakerLayoutType =
                 SSpeakerConfig3d::ESpeakerLayoutType::FLEXIBLESPEAKERCONFIG;
             break;
           case 3:
-            signalGroup->audioChannelLayout->speakerLayoutType =
+            channelLayout->speakerLayoutType =
                 SSpeakerConfig3d::ESpeakerLayoutType::CONTRIBUTIONMODE;
             break;
           default:
-            signalGroup->audioChannelLayout->speakerLayoutType =
-                SSpeakerConfig3d::ESpeakerLayoutType::INVALID;
+            channelLayout->speakerLayoutType = SSpeakerConfig3d::ESpeakerLayoutType::INVALID;
             ILO_ASSERT(false, "Invalid speaker layout type found.");
             break;
         }
 
-        signalGroup->audioChannelLayout->numSpeakers =
-            configInfo.signalGroups[grp].audioChannelLayout.numSpeakers;
-        signalGroup->audioChannelLayout->cicpSpeakerLayoutIdx =
+        channelLayout->numSpeakers = configInfo.signalGroups[grp].audioChannelLayout.numSpeakers;
+        channelLayout->cicpSpeakerLayoutIdx =
             configInfo.signalGroups[grp].audioChannelLayout.CICPIdx;
-        signalGroup->audioChannelLayout->cicpSpeakerIdx =
+        channelLayout->cicpSpeakerIdx =
             configInfo.signalGroups[grp].audioChannelLayout.CICPSpeakerIdx;
+        signalGroup->audioChannelLayout = channelLayout;
         break;
+      }
       case 1:
         signalGroup->signalGroupType = SSignals3d::SSignalGroup::ESignalGroupType::OBJECT;
         break;
@@ -249,8 +273,9 @@ void CMhasConfigPacket::SConfig::parsePayload(ilo::ByteBuffer::const_iterator be
     signalGroup->metaDataElementIds = configInfo.signalGroups[grp].metaDataElementIds;
 
     for (size_t i = 0; i < signalGroup->metaDataElementIds.size(); i++) {
-      signals3d.signals[signalGroup->metaDataElementIds[i]].signalGroup = signalGroup;
-      signals3d.signals[signalGroup->metaDataElementIds[i]].signalNumber = static_cast<uint8_t>(i);
+      SSignals3d::SSignal& signal = signals3d.signalTable[signalGroup->metaDataElementIds[i]];
+      signal.signalGroupIndex = signalGroup->idx;
+      signal.signalNumber = static_cast<uint8_t>(i);
     }
 
     signals3d.signalGroups.push_back(signalGroup);
@@ -290,25 +315,27 @@ bool CMhasConfigPacket::SSpeakerConfig3d::operator!=(const SSpeakerConfig3d& com
   return !(*this == compare);
 }
 
+std::shared_ptr<const CMhasConfigPacket::SSignals3d::SSignalGroup>
+CMhasConfigPacket::SSignals3d::signalGroup(const SSignal& signal) const {
+  if (!signal.isValid() || signal.signalGroupIndex >= signalGroups.size()) {
+    return nullptr;
+  }
+  return signalGroups[signal.signalGroupIndex];
+}
+
 void CMhasConfigPacket::SSignals3d::applyAsi(
     const CMhasAsiPacket::SAudioSceneInfo& audioSceneInfo) {
   if (!asiApplied) {
     appliedMetaDataElementIdOffset =
         static_cast<uint8_t>(audioSceneInfo.metaDataElementIDOffset + 1);
 
-    std::map<uint8_t, CMhasConfigPacket::SSignals3d::SSignal> newSignals;
-    for (auto& signal : signals) {
-      newSignals[static_cast<uint8_t>(signal.first + appliedMetaDataElementIdOffset)] =
-          signal.second;
-    }
-    signals = newSignals;
-
+    // Groups may be shared with cached configs, so the shifted IDs go into copies
     for (auto& signalGroup : signalGroups) {
-      std::vector<uint8_t> newMetaDataElementIds;
-      for (uint8_t id : signalGroup->metaDataElementIds) {
-        newMetaDataElementIds.push_back(static_cast<uint8_t>(appliedMetaDataElementIdOffset + id));
+      auto shiftedGroup = std::make_shared<SSignalGroup>(*signalGroup);
+      for (uint8_t& id : shiftedGroup->metaDataElementIds) {
+        id = static_cast<uint8_t>(id + appliedMetaDataElementIdOffset);
       }
-      signalGroup->metaDataElementIds = newMetaDataElementIds;
+      signalGroup = std::move(shiftedGroup);
     }
     asiApplied = true;
   }
@@ -316,16 +343,28 @@ void CMhasConfigPacket::SSignals3d::applyAsi(
 
 void CMhasConfigPacket::payload(ilo::ByteBuffer::const_iterator begin,
                                 ilo::ByteBuffer::const_iterator end) {
-  m_config.parsePayload(begin, end);
+  // Snapshots handed out before must not change
+  auto config = std::make_shared<SConfig>();
+  config->parsePayload(begin, end);
+  std::atomic_store(&m_config, std::shared_ptr<const SConfig>(std::move(config)));
   CMhasPacket::payload(begin, end);
 }
 
-CMhasConfigPacket::SConfig CMhasConfigPacket::mhasConfigInfo() const {
-  return m_config;
+const CMhasConfigPacket::SConfig& CMhasConfigPacket::mhasConfigInfo() const {
+  return *decodedConfig();
+}
+
+std::shared_ptr<const CMhasConfigPacket::SConfig> CMhasConfigPacket::mhasConfigSnapshot() const {
+  return decodedConfig();
+}
+
+bool CMhasConfigPacket::isDecoded() const {
+  return std::atomic_load(&m_config) != nullptr;
 }
 
 bool CMhasConfigPacket::isLcProfile() const {
-  return m_config.profileLevelIndication >= 0x0B && m_config.profileLevelIndication <= 0x0F;
+  const SConfig& config = *decodedConfig();
+  return config.profileLevelIndication >= 0x0B && config.profileLevelIndication <= 0x0F;
 }
 
 std::string CMhasConfigPacket::packetName() const {
@@ -0,0 +1,388 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <array>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MHAS_CRC16_CLMUL_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#define MHAS_CRC16_CLMUL_ARM
+#include <arm_neon.h>
+#endif
+
+#if defined(MHAS_CRC16_CLMUL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MHAS_CRC16_TARGET_CLMUL __attribute__((target("pclmul,ssse3")))
+#else
+#define MHAS_CRC16_TARGET_CLMUL
+#endif
+
+// Internal includes
+#include "logging.h"
+#include "mmtmhasparserlib/mhascrc16.h"
+
+using namespace mmt::mhasparserlib;
+
+namespace {
+// Byte ranges shorter than this are not worth the setup of the folding kernel, which needs at
+// least four 16-byte blocks.
+const std::size_t MIN_CLMUL_SIZE = 64;
+
+// Lookup tables and folding constants, built once on first use
+struct STables {
+  // slice[k][b] is the CRC of byte b followed by k zero bytes (with a CRC start value of 0)
+  std::array<std::array<uint16_t, 256>, 16> slice;
+  // x^(128 + 64) mod P and x^128 mod P, to fold a 128-bit block onto the next one
+  uint64_t fold128High;
+  uint64_t fold128Low;
+  // x^(512 + 64) mod P and x^512 mod P, to fold a 128-bit block onto the one four blocks later
+  uint64_t fold512High;
+  uint64_t fold512Low;
+};
+
+uint64_t xPowModPolynomial(uint32_t exponent) {
+  uint32_t remainder = 1u;
+  for (uint32_t i = 0; i < exponent; ++i) {
+    remainder <<= 1u;
+    if (remainder & 0x10000u) {
+      remainder ^= 0x10000u | CMhasCrc16::POLYNOMIAL;
+    }
+  }
+  return remainder;
+}
+
+STables createTables() {
+  STables tables;
+  for (uint32_t byte = 0; byte < 256; ++byte) {
+    uint32_t value = byte << 8u;
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      value = (value & 0x8000u) ? (value << 1u) ^ CMhasCrc16::POLYNOMIAL : value << 1u;
+    }
+    tables.slice[0][byte] = static_cast<uint16_t>(value);
+  }
+  for (std::size_t k = 1; k < tables.slice.size(); ++k) {
+    for (std::size_t byte = 0; byte < 256; ++byte) {
+      const uint16_t previous = tables.slice[k - 1][byte];
+      tables.slice[k][byte] =
+          static_cast<uint16_t>((previous << 8u) ^ tables.slice[0][previous >> 8u]);
+    }
+  }
+  tables.fold128High = xPowModPolynomial(128 + 64);
+  tables.fold128Low = xPowModPolynomial(128);
+  tables.fold512High = xPowModPolynomial(512 + 64);
+  tables.fold512Low = xPowModPolynomial(512);
+  return tables;
+}
+
+const STables& tables() {
+  static const STables s_tables = createTables();
+  return s_tables;
+}
+
+uint16_t updateBytewise(uint16_t crc, const uint8_t* data, std::size_t size) {
+  const auto& table = tables().slice[0];
+  for (std::size_t i = 0; i < size; ++i) {
+    crc = static_cast<uint16_t>((crc << 8u) ^ table[(crc >> 8u) ^ data[i]]);
+  }
+  return crc;
+}
+
+uint16_t updateSliceBy8(uint16_t crc, const uint8_t* data, std::size_t size) {
+  const auto& t = tables().slice;
+  for (; size >= 8; size -= 8, data += 8) {
+    crc = static_cast<uint16_t>(t[7][data[0] ^ (crc >> 8u)] ^ t[6][data[1] ^ (crc & 0xffu)] ^
+                                t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^
+                                t[1][data[6]] ^ t[0][data[7]]);
+  }
+  return updateBytewise(crc, data, size);
+}
+
+uint16_t updateSliceBy16(uint16_t crc, const uint8_t* data, std::size_t size) {
+  const auto& t = tables().slice;
+  for (; size >= 16; size -= 16, data += 16) {
+    crc = static_cast<uint16_t>(
+        t[15][data[0] ^ (crc >> 8u)] ^ t[14][data[1] ^ (crc & 0xffu)] ^ t[13][data[2]] ^
+        t[12][data[3]] ^ t[11][data[4]] ^ t[10][data[5]] ^ t[9][data[6]] ^ t[8][data[7]] ^
+        t[7][data[8]] ^ t[6][data[9]] ^ t[5][data[10]] ^ t[4][data[11]] ^ t[3][data[12]] ^
+        t[2][data[13]] ^ t[1][data[14]] ^ t[0][data[15]]);
+  }
+  return updateSliceBy8(crc, data, size);
+}
+
+/*
+ * The folding kernels treat 16 consecutive bytes as a polynomial of degree < 128 (first byte,
+ * most significant bit = highest coefficient). As CRC(crc, data) = crc * x^(8n) + data * x^16
+ * mod P, the CRC start value is added to the first 16 bits of the data. A block X is moved
+ * forward by D bits with X_high * (x^(D+64) mod P) + X_low * (x^D mod P), which has the same
+ * remainder and still fits into 128 bits. The remaining 128-bit value is reduced with the lookup
+ * tables.
+ */
+#if defined(MHAS_CRC16_CLMUL_X86)
+MHAS_CRC16_TARGET_CLMUL inline __m128i loadBlock(const uint8_t* data, __m128i reverse) {
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), reverse);
+}
+
+MHAS_CRC16_TARGET_CLMUL inline __m128i foldBlock(__m128i block, __m128i constants) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(block, constants, 0x00),
+                       _mm_clmulepi64_si128(block, constants, 0x11));
+}
+
+MHAS_CRC16_TARGET_CLMUL uint16_t updateClmul(uint16_t crc, const uint8_t* data, std::size_t size) {
+  const STables& t = tables();
+  const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i fold128 = _mm_set_epi64x(static_cast<int64_t>(t.fold128High),
+                                         static_cast<int64_t>(t.fold128Low));
+  const __m128i fold512 = _mm_set_epi64x(static_cast<int64_t>(t.fold512High),
+                                         static_cast<int64_t>(t.fold512Low));
+
+  __m128i block0 = _mm_xor_si128(loadBlock(data, reverse),
+                                 _mm_set_epi64x(static_cast<int64_t>(uint64_t{crc} << 48u), 0));
+  __m128i block1 = loadBlock(data + 16, reverse);
+  __m128i block2 = loadBlock(data + 32, reverse);
+  __m128i block3 = loadBlock(data + 48, reverse);
+  data += 64;
+  size -= 64;
+
+  for (; size >= 64; size -= 64, data += 64) {
+    block0 = _mm_xor_si128(foldBlock(block0, fold512), loadBlock(data, reverse));
+    block1 = _mm_xor_si128(foldBlock(block1, fold512), loadBlock(data + 16, reverse));
+    block2 = _mm_xor_si128(foldBlock(block2, fold512), loadBlock(data + 32, reverse));
+    block3 = _mm_xor_si128(foldBlock(block3, fold512), loadBlock(data + 48, reverse));
+  }
+
+  block1 = _mm_xor_si128(foldBlock(block0, fold128), block1);
+  block2 = _mm_xor_si128(foldBlock(block1, fold128), block2);
+  block3 = _mm_xor_si128(foldBlock(block2, fold128), block3);
+  for (; size >= 16; size -= 16, data += 16) {
+    block3 = _mm_xor_si128(foldBlock(block3, fold128), loadBlock(data, reverse));
+  }
+
+  uint8_t remainder[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(remainder), _mm_shuffle_epi8(block3, reverse));
+  crc = updateSliceBy16(0, remainder, sizeof(remainder));
+  return updateSliceBy8(crc, data, size);
+}
+
+bool isClmulSupported() {
+#if defined(_MSC_VER)
+  int info[4] = {};
+  __cpuid(info, 1);
+  const auto ecx = static_cast<uint32_t>(info[2]);
+#else
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+#endif
+  // CPUID.1:ECX bit 1 is PCLMULQDQ, bit 9 is SSSE3
+  return (ecx & (1u << 1u)) != 0 && (ecx & (1u << 9u)) != 0;
+}
+#elif defined(MHAS_CRC16_CLMUL_ARM)
+inline uint64x2_t loadBlock(const uint8_t* data) {
+  const uint64x2_t swapped = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(data)));
+  return vextq_u64(swapped, swapped, 1);
+}
+
+inline uint64x2_t foldBlock(uint64x2_t block, uint64x2_t constants) {
+  const poly128_t low = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(block, 0)),
+                                  static_cast<poly64_t>(vgetq_lane_u64(constants, 0)));
+  const poly128_t high =
+      vmull_high_p64(vreinterpretq_p64_u64(block), vreinterpretq_p64_u64(constants));
+  return veorq_u64(vreinterpretq_u64_p128(low), vreinterpretq_u64_p128(high));
+}
+
+uint16_t updateClmul(uint16_t crc, const uint8_t* data, std::size_t size) {
+  const STables& t = tables();
+  const uint64x2_t fold128 = vcombine_u64(vcreate_u64(t.fold128Low), vcreate_u64(t.fold128High));
+  const uint64x2_t fold512 = vcombine_u64(vcreate_u64(t.fold512Low), vcreate_u64(t.fold512High));
+
+  uint64x2_t block0 = veorq_u64(
+      loadBlock(data), vcombine_u64(vcreate_u64(0), vcreate_u64(uint64_t{crc} << 48u)));
+  uint64x2_t block1 = loadBlock(data + 16);
+  uint64x2_t block2 = loadBlock(data + 32);
+  uint64x2_t block3 = loadBlock(data + 48);
+  data += 64;
+  size -= 64;
+
+  for (; size >= 64; size -= 64, data += 64) {
+    block0 = veorq_u64(foldBlock(block0, fold512), loadBlock(data));
+    block1 = veorq_u64(foldBlock(block1, fold512), loadBlock(data + 16));
+    block2 = veorq_u64(foldBlock(block2, fold512), loadBlock(data + 32));
+    block3 = veorq_u64(foldBlock(block3, fold512), loadBlock(data + 48));
+  }
+
+  block1 = veorq_u64(foldBlock(block0, fold128), block1);
+  block2 = veorq_u64(foldBlock(block1, fold128), block2);
+  block3 = veorq_u64(foldBlock(block2, fold128), block3);
+  for (; size >= 16; size -= 16, data += 16) {
+    block3 = veorq_u64(foldBlock(block3, fold128), loadBlock(data));
+  }
+
+  uint8_t remainder[16];
+  const uint64x2_t swapped = vextq_u64(block3, block3, 1);
+  vst1q_u8(remainder, vrev64q_u8(vreinterpretq_u8_u64(swapped)));
+  crc = updateSliceBy16(0, remainder, sizeof(remainder));
+  return updateSliceBy8(crc, data, size);
+}
+
+bool isClmulSupported() {
+  // The kernel is only compiled if the target guarantees the crypto extension
+  return true;
+}
+#else
+uint16_t updateClmul(uint16_t crc, const uint8_t* data, std::size_t size) {
+  return updateSliceBy16(crc, data, size);
+}
+
+bool isClmulSupported() {
+  return false;
+}
+#endif
+
+bool hasClmul() {
+  static const bool s_hasClmul = isClmulSupported();
+  return s_hasClmul;
+}
+}  // namespace
+
+void CMhasCrc16::update(const uint8_t* data, std::size_t size) {
+  m_crc = s_update(m_crc, data, size);
+}
+
+void CMhasCrc16::update(const SByteSpan& data) {
+  m_crc = s_update(m_crc, data.data, data.size);
+}
+
+uint16_t CMhasCrc16::value() const {
+  return m_crc;
+}
+
+void CMhasCrc16::reset() {
+  m_crc = INITIAL_VALUE;
+}
+
+uint16_t CMhasCrc16::s_calculate(const SByteSpan& data) {
+  return s_update(INITIAL_VALUE, data.data, data.size);
+}
+
+uint16_t CMhasCrc16::s_update(uint16_t crc, const uint8_t* data, std::size_t size,
+                              EImplementation implementation) {
+  if (implementation == EImplementation::Auto) {
+    if (size >= MIN_CLMUL_SIZE && hasClmul()) {
+      implementation = EImplementation::CarrylessMultiply;
+    } else {
+      implementation = size >= 16 ? EImplementation::SliceBy16 : EImplementation::Bytewise;
+    }
+  }
+
+  switch (implementation) {
+    case EImplementation::Bytewise:
+      return updateBytewise(crc, data, size);
+    case EImplementation::SliceBy8:
+      return updateSliceBy8(crc, data, size);
+    case EImplementation::SliceBy16:
+      return updateSliceBy16(crc, data, size);
+    case EImplementation::CarrylessMultiply:
+      ILO_ASSERT_WITH(hasClmul(), std::invalid_argument,
+                      "Carry-less multiplication is not supported on this CPU.");
+      return size >= MIN_CLMUL_SIZE ? updateClmul(crc, data, size)
+                                    : updateSliceBy16(crc, data, size);
+    default:
+      ILO_FAIL_WITH(std::invalid_argument, "Invalid CRC16 implementation.");
+      return crc;
+  }
+}
+
+bool CMhasCrc16::s_isSupported(EImplementation implementation) {
+  return implementation != EImplementation::CarrylessMultiply || hasClmul();
+}
+
+CMhasCrc16::EImplementation CMhasCrc16::s_preferredImplementation() {
+  return hasClmul() ? EImplementation::CarrylessMultiply : EImplementation::SliceBy16;
+}
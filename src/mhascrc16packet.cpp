@@ -82,9 +82,9 @@ amm-info@iis.fraunhofer.de
 
 // System includes
 #include <stdexcept>
+#include <utility>
 
 // External includes
-#include "ilo/bitparser.h"
 #include "ilo/common_types.h"
 
 // Internal includes
@@ -107,19 +107,33 @@ CMhasCRC16Packet::CMhasCRC16Packet(uint64_t label, uint16_t crc)
 CMhasCRC16Packet::CMhasCRC16Packet(ilo::ByteBuffer::const_iterator& begin,
                                    ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload();
+}
+
+CMhasCRC16Packet::CMhasCRC16Packet(const SMhasPacketHeader& header, const uint8_t* payload,
+                                   std::shared_ptr<const uint8_t> payloadOwner)
+    : CMhasPacket(header, payload, std::move(payloadOwner)) {
+  initFromPayload();
+}
+
+void CMhasCRC16Packet::initFromPayload() {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_CRC16,
                   std::invalid_argument, "Invalid packet type.");
-  ILO_ASSERT_WITH(m_payload.size() == 2, std::invalid_argument,
+  ILO_ASSERT_WITH(s_isValidPayload(payloadSpan()), std::invalid_argument,
                   "The payload size must be two bytes (16 bit).");
-  ilo::CBitParser parser(m_payload);
+  const SByteSpan payload = payloadSpan();
 
-  m_crc = parser.read<uint16_t>(16);
+  m_crc = static_cast<uint16_t>((payload.data[0] << 8u) | payload.data[1]);
 }
 
 uint16_t CMhasCRC16Packet::crc16() const {
   return m_crc;
 }
 
+bool CMhasCRC16Packet::s_isValidPayload(const SByteSpan& payload) {
+  return payload.size == 2;
+}
+
 std::string CMhasCRC16Packet::packetName() const {
   return "CRC16-Packet";
 }
@@ -0,0 +1,224 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <iterator>
+#include <utility>
+
+// Internal includes
+#include "mmtmhasparserlib/mhasdecodecache.h"
+
+using namespace mmt::mhasparserlib;
+
+// 64 bit FNV-1a, payloads are short and only hashed once per lookup
+static uint64_t hashPayload(uint32_t packetType, const ilo::ByteBuffer& payload) {
+  uint64_t hash = 0xcbf29ce484222325ull ^ packetType;
+  for (uint8_t byte : payload) {
+    hash ^= byte;
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+const std::size_t CMhasDecodeCache::DEFAULT_MAX_PAYLOAD_BYTES = 1024 * 1024;
+
+CMhasDecodeCache::CMhasDecodeCache(std::size_t maxEntries, std::size_t maxPayloadBytes)
+    : m_maxEntries(maxEntries), m_maxPayloadBytes(maxPayloadBytes) {}
+
+CMhasDecodeCache& CMhasDecodeCache::s_global() {
+  static CMhasDecodeCache s_cache;
+  return s_cache;
+}
+
+void CMhasDecodeCache::maxEntries(std::size_t maxEntries) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxEntries = maxEntries;
+  evict(maxEntries, m_maxPayloadBytes);
+}
+
+std::size_t CMhasDecodeCache::maxEntries() const {
+  return m_maxEntries;
+}
+
+void CMhasDecodeCache::maxPayloadBytes(std::size_t maxPayloadBytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxPayloadBytes = maxPayloadBytes;
+  evict(m_maxEntries, maxPayloadBytes);
+}
+
+std::size_t CMhasDecodeCache::maxPayloadBytes() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_maxPayloadBytes;
+}
+
+std::shared_ptr<const void> CMhasDecodeCache::internErased(uint32_t packetType,
+                                                          const ilo::ByteBuffer& payload,
+                                                          const CErasedDecode& decode) {
+  if (m_maxEntries == 0) {
+    return decode();
+  }
+
+  const uint64_t hash = hashPayload(packetType, payload);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = find(hash, packetType, payload);
+    if (entry != m_entries.end()) {
+      ++m_statistics.hits;
+      return entry->decoded;
+    }
+    ++m_statistics.misses;
+  }
+
+  auto decoded = decode();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Another thread may have decoded the same payload in the meantime
+  auto entry = find(hash, packetType, payload);
+  if (entry != m_entries.end()) {
+    return entry->decoded;
+  }
+  if (m_maxEntries == 0 || payload.size() > m_maxPayloadBytes) {
+    return decoded;
+  }
+
+  evict(m_maxEntries - 1, m_maxPayloadBytes - payload.size());
+  SEntry newEntry;
+  newEntry.hash = hash;
+  newEntry.packetType = packetType;
+  newEntry.payload = payload;
+  newEntry.decoded = decoded;
+  m_entries.push_front(std::move(newEntry));
+  m_index.emplace(hash, m_entries.begin());
+  m_statistics.payloadBytes += payload.size();
+  m_statistics.entries = m_entries.size();
+  return decoded;
+}
+
+CMhasDecodeCache::SStatistics CMhasDecodeCache::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+void CMhasDecodeCache::resetStatistics() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_statistics.hits = 0;
+  m_statistics.misses = 0;
+  m_statistics.evictions = 0;
+}
+
+void CMhasDecodeCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_index.clear();
+  m_entries.clear();
+  m_statistics.entries = 0;
+  m_statistics.payloadBytes = 0;
+}
+
+CMhasDecodeCache::CEntryList::iterator CMhasDecodeCache::find(uint64_t hash, uint32_t packetType,
+                                                              const ilo::ByteBuffer& payload) {
+  auto range = m_index.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto entry = it->second;
+    if (entry->packetType == packetType && entry->payload == payload) {
+      m_entries.splice(m_entries.begin(), m_entries, entry);
+      return entry;
+    }
+  }
+  return m_entries.end();
+}
+
+void CMhasDecodeCache::evict(std::size_t maxEntries, std::size_t maxPayloadBytes) {
+  while (m_entries.size() > maxEntries || m_statistics.payloadBytes > maxPayloadBytes) {
+    const SEntry& entry = m_entries.back();
+    auto range = m_index.equal_range(entry.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == std::prev(m_entries.end())) {
+        m_index.erase(it);
+        break;
+      }
+    }
+    m_statistics.payloadBytes -= entry.payload.size();
+    m_entries.pop_back();
+    ++m_statistics.evictions;
+  }
+  m_statistics.entries = m_entries.size();
+}
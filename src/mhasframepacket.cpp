@@ -98,6 +98,16 @@ CMhasFramePacket::CMhasFramePacket(ilo::ByteBuffer::const_iterator& begin,
   validate();
 }
 
+CMhasFramePacket::CMhasFramePacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                   const bool preRollConfigPresent,
+                                   std::shared_ptr<const uint8_t> payloadOwner)
+    : CMhasPacket(header, payload, std::move(payloadOwner)),
+      m_preRollConfigPresent(preRollConfigPresent) {
+  ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_MPEGH3DAFRAME,
+                  std::invalid_argument, "Invalid packet type.");
+  validate();
+}
+
 CMhasFramePacket::CMhasFramePacket(uint64_t label, ilo::ByteBuffer::const_iterator payloadBegin,
                                    ilo::ByteBuffer::const_iterator payloadEnd,
                                    const bool preRollConfigPresent)
@@ -109,17 +119,25 @@ CMhasFramePacket::CMhasFramePacket(uint64_t label, ilo::ByteBuffer::const_iterat
 }
 
 bool CMhasFramePacket::isIPF() const {
-  if (m_payload.empty() || !m_preRollConfigPresent) {
+  return s_isIPF(payloadSpan(), m_preRollConfigPresent);
+}
+
+bool CMhasFramePacket::isIF() const {
+  return s_isIF(payloadSpan());
+}
+
+bool CMhasFramePacket::s_isIPF(const SByteSpan& payload, bool preRollConfigPresent) {
+  if (payload.empty() || !preRollConfigPresent) {
     return false;
   }
-  return (m_payload[0] & 0xE0u) == 0xC0u;
+  return (payload[0] & 0xE0u) == 0xC0u;
 }
 
-bool CMhasFramePacket::isIF() const {
-  if (m_payload.empty()) {
+bool CMhasFramePacket::s_isIF(const SByteSpan& payload) {
+  if (payload.empty()) {
     return false;
   }
-  return (m_payload[0] & 0x80u) == 0x80u;
+  return (payload[0] & 0x80u) == 0x80u;
 }
 
 std::string CMhasFramePacket::packetName() const {
@@ -127,9 +145,14 @@ std::string CMhasFramePacket::packetName() const {
 }
 
 void CMhasFramePacket::validate() const {
-  if (m_preRollConfigPresent) {
-    ILO_ASSERT(!m_payload.empty() && (m_payload[0] & 0xE0u) != 0xE0u /* 111 */ &&
-                   (m_payload[0] & 0xC0u) != 0x40u /* 01 */,
-               "Invalid bit sequence for frame-packet.");
+  ILO_ASSERT(s_isValidPayload(payloadSpan(), m_preRollConfigPresent),
+             "Invalid bit sequence for frame-packet.");
+}
+
+bool CMhasFramePacket::s_isValidPayload(const SByteSpan& payload, bool preRollConfigPresent) {
+  if (!preRollConfigPresent) {
+    return true;
   }
+  return !payload.empty() && (payload[0] & 0xE0u) != 0xE0u /* 111 */ &&
+         (payload[0] & 0xC0u) != 0x40u /* 01 */;
 }
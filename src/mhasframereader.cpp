@@ -0,0 +1,169 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+// Internal includes
+#include "logging.h"
+#include "mmtmhasparserlib/mhasframereader.h"
+
+using namespace mmt::mhasparserlib;
+
+const std::size_t CMhasFrameReader::DEFAULT_READ_SIZE = 4096;
+
+CMhasFrameReader::CMhasFrameReader() {}
+
+CMhasFrameReader::CMhasFrameReader(const uint8_t* data, std::size_t size)
+    : m_data(data), m_dataSize(size) {
+  ILO_ASSERT_WITH(data != nullptr || size == 0, std::invalid_argument,
+                  "No data provided for a non-empty buffer");
+}
+
+void CMhasFrameReader::feed(const ilo::ByteBuffer& buffer) {
+  feed(buffer.data(), buffer.size());
+}
+
+void CMhasFrameReader::feed(const uint8_t* data, std::size_t size) {
+  m_parser.feed(data, size);
+  m_bytesFed += size;
+  m_isParsePending = true;
+}
+
+CPacketDeque CMhasFrameReader::nextFrame() {
+  ILO_ASSERT(m_parser.outputQueue() == nullptr,
+             "The parser of a frame reader must not have an output queue");
+
+  CPacketDeque frame;
+  while (!takeFrame(frame)) {
+    if (m_isParsePending) {
+      parsePackets();
+    } else if (m_dataFed < m_dataSize) {
+      auto size = std::min(DEFAULT_READ_SIZE, m_dataSize - m_dataFed);
+      feed(m_data + m_dataFed, size);
+      m_dataFed += size;
+    } else {
+      break;
+    }
+  }
+  return frame;
+}
+
+uint64_t CMhasFrameReader::position() const {
+  return m_bytesFed - m_parser.numBytesPending() - m_lookaheadBytes;
+}
+
+CMhasParser& CMhasFrameReader::parser() {
+  return m_parser;
+}
+
+bool CMhasFrameReader::takeFrame(CPacketDeque& frame) {
+  for (; m_numScannedPackets < m_lookahead.size(); ++m_numScannedPackets) {
+    if (m_lookahead[m_numScannedPackets]->packetType() ==
+        static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+      auto end = m_lookahead.begin() + static_cast<std::ptrdiff_t>(m_numScannedPackets + 1);
+      for (auto it = m_lookahead.begin(); it != end; ++it) {
+        m_lookaheadBytes -= (*it)->calculatePacketSize();
+      }
+
+      frame.insert(frame.end(), std::make_move_iterator(m_lookahead.begin()),
+                   std::make_move_iterator(end));
+      m_lookahead.erase(m_lookahead.begin(), end);
+      m_numScannedPackets = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CMhasFrameReader::parsePackets() {
+  m_isParsePending = false;
+  m_parser.parsePackets();
+
+  while (CUniqueMhasPacket packet = m_parser.nextPacket()) {
+    m_lookaheadBytes += packet->calculatePacketSize();
+    m_lookahead.push_back(std::move(packet));
+  }
+}
@@ -86,6 +86,7 @@ amm-info@iis.fraunhofer.de
 #include <map>
 #include <numeric>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 // External includes
@@ -93,6 +94,7 @@ amm-info@iis.fraunhofer.de
 
 // Internal includes
 #include "logging.h"
+#include "mmtmhasparserlib/mhasframereader.h"
 #include "mmtmhasparserlib/mhashelpertools.h"
 #include "mmtmhasparserlib/mhasutilities.h"
 
@@ -106,50 +108,75 @@ struct SPreroll {
 
 static uint64_t calculatePreRollSizeInBits(const SPreroll& preroll) {
   uint64_t size = 0;
-  size += tools::calculateEscapedValueBitCount(preroll.config.size(), 4, 4, 8);
+  size += escapedBits<4, 4, 8>(preroll.config.size());
   size += preroll.config.size() * 8;
 
   size += 2;  // applyCrossfade and reserved
-  size += tools::calculateEscapedValueBitCount(preroll.aus.size(), 2, 4, 0);
+  size += escapedBits<2, 4, 0>(preroll.aus.size());
 
   for (const auto& au : preroll.aus) {
-    size += tools::calculateEscapedValueBitCount(au.size(), 16, 16, 0);
+    size += escapedBits<16, 16, 0>(au.size());
     size += au.size() * 8;
   }
   return size;
 }
 
+// Copies the given number of bits from the read position of the parser to the write position of
+// the writer and advances both. source and dest are the buffers the parser and writer work on.
+static void copyBits(ilo::CBitParser& parser, const uint8_t* source, ilo::CBitBuffer& writer,
+                     uint8_t* dest, size_t destSize, size_t numBits) {
+  ILO_ASSERT(numBits <= parser.nofBits() - parser.nofReadBits(), "Not enough bits to read.");
+  ILO_ASSERT(writer.tell() + numBits <= destSize * 8, "Not enough space to write bits.");
+
+  copyBits(source, parser.tell(), dest, writer.tell(), numBits);
+  parser.seek(static_cast<int32_t>(numBits), ilo::EPosType::cur);
+  writer.seek(static_cast<int32_t>(numBits), ilo::EPosType::cur);
+}
+
+// Reads bytes from the read position of the parser, which works on source, into the given buffer.
+static void readBytes(ilo::CBitParser& parser, const uint8_t* source, ilo::ByteBuffer& bytes) {
+  ILO_ASSERT(bytes.size() * 8 <= parser.nofBits() - parser.nofReadBits(),
+             "Not enough bits to read.");
+
+  copyBits(source, parser.tell(), bytes.data(), 0, bytes.size() * 8);
+  parser.seek(static_cast<int32_t>(bytes.size() * 8), ilo::EPosType::cur);
+}
+
+// Writes the given bytes at the write position of the writer, which works on dest.
+static void writeBytes(ilo::CBitBuffer& writer, uint8_t* dest, size_t destSize,
+                       const ilo::ByteBuffer& bytes) {
+  ILO_ASSERT(writer.tell() + bytes.size() * 8 <= destSize * 8, "Not enough space to write bits.");
+
+  copyBits(bytes.data(), 0, dest, writer.tell(), bytes.size() * 8);
+  writer.seek(static_cast<int32_t>(bytes.size() * 8), ilo::EPosType::cur);
+}
+
 // Extracts the preroll from the given bitparser (read position should be set to the first bit of
-// the AudioPreRoll struct (Table 58 of ISO/IEC 23008-3)
-static SPreroll extractPreroll(ilo::CBitParser& frameParser, size_t prerollSize = 0u) {
+// the AudioPreRoll struct (Table 58 of ISO/IEC 23008-3). frameData is the buffer the parser works
+// on.
+static SPreroll extractPreroll(ilo::CBitParser& frameParser, const uint8_t* frameData,
+                               size_t prerollSize = 0u) {
   SPreroll preroll{};
   uint8_t byte = 0;
 
   auto begin = frameParser.tell();
-  auto configLen = static_cast<size_t>(readEscapedValue(frameParser, 4, 4, 8));
+  auto configLen = static_cast<size_t>(readEscaped<4, 4, 8>(frameParser));
 
   if (configLen != 0) {
     preroll.config.resize(configLen);
-    for (size_t currentByteIndex = 0; currentByteIndex < configLen; ++currentByteIndex) {
-      byte = frameParser.read<uint8_t>(8);
-      preroll.config[currentByteIndex] = byte;
-    }
+    readBytes(frameParser, frameData, preroll.config);
   }
 
   byte = frameParser.read<uint8_t>(2);
   preroll.applyCrossfade = (byte & 0x2u) == 0x2u;
 
-  auto numPreRollFrames = static_cast<size_t>(readEscapedValue(frameParser, 2, 4, 0));
+  auto numPreRollFrames = static_cast<size_t>(readEscaped<2, 4, 0>(frameParser));
   preroll.aus.resize(numPreRollFrames);
 
   for (auto& au : preroll.aus) {
-    size_t auLen = static_cast<size_t>(readEscapedValue(frameParser, 16, 16, 0));
+    size_t auLen = static_cast<size_t>(readEscaped<16, 16, 0>(frameParser));
     au.resize(auLen);
-
-    for (size_t currentByteIndex = 0; currentByteIndex < auLen; ++currentByteIndex) {
-      byte = frameParser.read<uint8_t>(8);
-      au[currentByteIndex] = byte;
-    }
+    readBytes(frameParser, frameData, au);
   }
 
   auto end = frameParser.tell();
@@ -164,23 +191,20 @@ static SPreroll extractPreroll(ilo::CBitParser& frameParser, size_t prerollSize
   return preroll;
 }
 
-static size_t writePreroll(ilo::CBitBuffer& frameWriter, const SPreroll& preroll) {
+// frameData is the buffer of frameSize bytes the writer works on
+static size_t writePreroll(ilo::CBitBuffer& frameWriter, uint8_t* frameData, size_t frameSize,
+                           const SPreroll& preroll) {
   auto begin = frameWriter.tell();
-  writeEscapedValue(frameWriter, preroll.config.size(), 4, 4, 8);
-
-  for (const auto& byte : preroll.config) {
-    frameWriter.write(byte, 8);
-  }
+  writeEscaped<4, 4, 8>(frameWriter, preroll.config.size());
+  writeBytes(frameWriter, frameData, frameSize, preroll.config);
 
   frameWriter.write((preroll.applyCrossfade) ? 1u : 0u, 1);
   frameWriter.write(0u, 1);
-  writeEscapedValue(frameWriter, preroll.aus.size(), 2, 4, 0);
+  writeEscaped<2, 4, 0>(frameWriter, preroll.aus.size());
 
   for (const auto& au : preroll.aus) {
-    writeEscapedValue(frameWriter, au.size(), 16, 16, 0);
-    for (const auto& byte : au) {
-      frameWriter.write(byte, 8);
-    }
+    writeEscaped<16, 16, 0>(frameWriter, au.size());
+    writeBytes(frameWriter, frameData, frameSize, au);
   }
 
   auto bits = frameWriter.tell() - begin;
@@ -212,14 +236,9 @@ static void writeFlagsAndPayloadLength(ilo::CBitBuffer& writer, uint64_t payload
   }
 }
 
-static void copyPayload(ilo::CBitParser& source, ilo::CBitBuffer& dest) {
-  while (!source.eof()) {
-    uint8_t bitsToRead =
-        static_cast<uint8_t>(std::min(8u, source.nofBits() - source.nofReadBits()));
-
-    auto value = source.read<uint8_t>(bitsToRead);
-    dest.write(value, bitsToRead);
-  }
+static void copyPayload(ilo::CBitParser& source, const uint8_t* sourceData, ilo::CBitBuffer& dest,
+                        uint8_t* destData, size_t destSize) {
+  copyBits(source, sourceData, dest, destData, destSize, source.nofBits() - source.nofReadBits());
 }
 
 CPacketDeque tools::readNextFrame(ilo::ByteBuffer::const_iterator& begin,
@@ -229,43 +248,14 @@ CPacketDeque tools::readNextFrame(ilo::ByteBuffer::const_iterator& begin,
   }
   ILO_ASSERT(begin < end, "Invalid range provided");
 
-  const int32_t DEFAULT_READ_SIZE = 512;
-  auto currentFeedPosition = begin;
-  auto currentOutputPosition = begin;
-
-  CMhasParser mhasParser;
+  CMhasFrameReader frameReader(&begin[0], static_cast<std::size_t>(end - begin));
+  frameReader.parser().sync();
 
-  bool frameFound = false;
-
-  CPacketDeque returnQueue;
-  while (!frameFound) {
-    auto bytesToRead = (end - currentFeedPosition) >= DEFAULT_READ_SIZE ? DEFAULT_READ_SIZE
-                                                                        : end - currentFeedPosition;
-    if (bytesToRead <= 0) {
-      break;
-    }
-    mhasParser.sync();
-    mhasParser.feed(&currentFeedPosition[0], static_cast<std::size_t>(bytesToRead));
-    currentFeedPosition += bytesToRead;
-    mhasParser.parsePackets();
-
-    auto allPackets = mhasParser.allAvailablePackets();
-    for (auto& packet : allPackets) {
-      currentOutputPosition += packet->calculatePacketSize();
-      returnQueue.push_back(std::move(packet));
-      if (returnQueue.back()->packetType() == (uint32_t)EMhasPacketType::PACTYP_MPEGH3DAFRAME) {
-        frameFound = true;
-        break;
-      }
-    }
+  auto frame = frameReader.nextFrame();
+  if (!frame.empty()) {
+    begin += static_cast<std::ptrdiff_t>(frameReader.position());
   }
-
-  if (!frameFound) {
-    return CPacketDeque{};
-  }
-
-  begin = currentOutputPosition;
-  return returnQueue;
+  return frame;
 }
 
 void tools::embedConfigurationIntoPreRoll(CMhasFramePacket& frame,
@@ -289,7 +279,7 @@ void tools::embedConfigurationIntoPreRoll(ilo::ByteBuffer& au,
 
   // usacExtElementPayloadLenght
   auto payloadLength = readPayloadLength(auParser);
-  auto preroll = extractPreroll(auParser, payloadLength);
+  auto preroll = extractPreroll(auParser, au.data(), payloadLength);
   ILO_ASSERT(preroll.config.empty(), "The provided IPF already contains a configuration");
   preroll.config = mpegh3daConfig;
   auto calculatedPrerollSize = (calculatePreRollSizeInBits(preroll) + 7) / 8;
@@ -302,8 +292,8 @@ void tools::embedConfigurationIntoPreRoll(ilo::ByteBuffer& au,
   ilo::ByteBuffer finalBuffer(finalSizeInBytes, 0);
   ilo::CBitBuffer auWriter(finalBuffer, static_cast<uint32_t>(finalBuffer.size() * 8));
   writeFlagsAndPayloadLength(auWriter, calculatedPrerollSize);
-  writePreroll(auWriter, preroll);
-  copyPayload(auParser, auWriter);
+  writePreroll(auWriter, finalBuffer.data(), finalBuffer.size(), preroll);
+  copyPayload(auParser, au.data(), auWriter, finalBuffer.data(), finalBuffer.size());
 
   ILO_ASSERT(finalSizeInBit == auWriter.tell(), "Preallocation failed.");
 
@@ -320,7 +310,7 @@ CPacketDeque::const_iterator tools::findPacketWithType(const CPacketDeque& packe
 
 void tools::writePacketsToByteBuffer(const CPacketDeque& packetDeque, ilo::ByteBuffer& buffer) {
   auto size = std::accumulate(packetDeque.begin(), packetDeque.end(), uint32_t{0},
-                              [](uint32_t sum, const std::unique_ptr<CMhasPacket>& packet) {
+                              [](uint32_t sum, const CUniqueMhasPacket& packet) {
                                 return sum + packet->calculatePacketSize();
                               });
 
@@ -339,16 +329,7 @@ void tools::writePacketsToByteBuffer(const CPacketDeque& packetDeque, ilo::ByteB
 
 uint64_t tools::calculateEscapedValueBitCount(uint64_t value, uint32_t first, uint32_t second,
                                               uint32_t third) {
-  uint64_t bits = first;
-  if (value >= (2u << (first - 1)) - 1) {
-    bits += second;
-    value -= (2u << (first - 1)) - 1;
-    if (value >= (2u << (second - 1)) - 1) {
-      bits += third;
-    }
-  }
-
-  return bits;
+  return escapedValueBits(value, first, second, third);
 }
 
 void parseAndCopySpeakerConfig3d(ilo::CBitParser& bitParser, ilo::CBitBuffer& bitBuffer) {
@@ -359,8 +340,8 @@ void parseAndCopySpeakerConfig3d(ilo::CBitParser& bitParser, ilo::CBitBuffer& bi
   if (speakerLayoutType == 0) {
     bitBuffer.write(bitParser.read<uint8_t>(6), 6);
   } else {
-    auto numSpeakers = static_cast<uint32_t>(readEscapedValue(bitParser, 5, 8, 16) + 1);
-    writeEscapedValue(bitBuffer, numSpeakers - 1, 5, 8, 16);
+    auto numSpeakers = static_cast<uint32_t>(readEscaped<5, 8, 16>(bitParser) + 1);
+    writeEscaped<5, 8, 16>(bitBuffer, numSpeakers - 1);
 
     switch (speakerLayoutType) {
       case 1:
@@ -449,8 +430,8 @@ void parseAndCopyFrameworkConfig3d(ilo::CBitParser& bitParser, ilo::CBitBuffer&
     auto signalGroupType = bitParser.read<uint32_t>(3);
     bitBuffer.write(signalGroupType, 3);
 
-    auto bsNumberOfSignals = static_cast<uint32_t>(readEscapedValue(bitParser, 5, 8, 16));
-    writeEscapedValue(bitBuffer, bsNumberOfSignals, 5, 8, 16);
+    auto bsNumberOfSignals = static_cast<uint32_t>(readEscaped<5, 8, 16>(bitParser));
+    writeEscaped<5, 8, 16>(bitBuffer, bsNumberOfSignals);
 
     numberOfSignals += bsNumberOfSignals + 1;
 
@@ -557,7 +538,15 @@ void parseAndCopyMps212Config(ilo::CBitParser& bitParser, ilo::CBitBuffer& bitBu
   }
 }
 
+// Buffers the config parser and writer work on, used to copy embedded byte runs in bulk
+struct SConfigBuffers {
+  const uint8_t* source = nullptr;
+  uint8_t* dest = nullptr;
+  size_t destSize = 0;
+};
+
 void parseAndCopyMpegh3daDecoderConfig(ilo::CBitParser& bitParser, ilo::CBitBuffer& bitBuffer,
+                                       const SConfigBuffers& buffers,
                                        uint32_t coreSbrFrameLengthIndex, uint32_t numberOfSignals) {
   uint32_t enhancedNoiseFilling = 0;
 
@@ -570,8 +559,8 @@ void parseAndCopyMpegh3daDecoderConfig(ilo::CBitParser& bitParser, ilo::CBitBuff
   uint8_t numOfBits =
       static_cast<uint8_t>(static_cast<uint8_t>(log(numberOfSignals - 1) / log(2)) + 1);
 
-  auto numElements = static_cast<uint32_t>(readEscapedValue(bitParser, 4, 8, 16) + 1);
-  writeEscapedValue(bitBuffer, numElements - 1, 4, 8, 16);
+  auto numElements = static_cast<uint32_t>(readEscaped<4, 8, 16>(bitParser) + 1);
+  writeEscaped<4, 8, 16>(bitBuffer, numElements - 1);
 
   bool elementLengthPresent = bitParser.read<uint32_t>(1) == 1u;
   bitBuffer.write(elementLengthPresent);
@@ -645,31 +634,29 @@ void parseAndCopyMpegh3daDecoderConfig(ilo::CBitParser& bitParser, ilo::CBitBuff
 
       case 3:  // ID_USAC_EXT
       {
-        auto usacExtElementType = static_cast<uint32_t>(readEscapedValue(bitParser, 4, 8, 16));
-        writeEscapedValue(bitBuffer, usacExtElementType, 4, 8, 16);
+        auto usacExtElementType = static_cast<uint32_t>(readEscaped<4, 8, 16>(bitParser));
+        writeEscaped<4, 8, 16>(bitBuffer, usacExtElementType);
 
         // usacExtElementConfigLength
         auto usacExtElementConfigLength =
-            static_cast<uint32_t>(readEscapedValue(bitParser, 4, 8, 16));
-        writeEscapedValue(bitBuffer, usacExtElementConfigLength, 4, 8, 16);
+            static_cast<uint32_t>(readEscaped<4, 8, 16>(bitParser));
+        writeEscaped<4, 8, 16>(bitBuffer, usacExtElementConfigLength);
 
         bool usacExtElementDefaultLengthPresent = bitParser.read<uint32_t>(1) == 1u;
         bitBuffer.write(usacExtElementDefaultLengthPresent);
 
         if (usacExtElementDefaultLengthPresent) {
           auto usacExtElementDefaultLength =
-              static_cast<uint32_t>(readEscapedValue(bitParser, 8, 16, 0));
-          writeEscapedValue(bitBuffer, usacExtElementDefaultLength, 8, 16, 0);
+              static_cast<uint32_t>(readEscaped<8, 16, 0>(bitParser));
+          writeEscaped<8, 16, 0>(bitBuffer, usacExtElementDefaultLength);
         }
 
         bool usacExtElementPayloadFrag = bitParser.read<uint32_t>(1) == 1u;
         bitBuffer.write(usacExtElementPayloadFrag);
 
         // Copying usacExtElement bytes
-        for (uint32_t i = 0; i < usacExtElementConfigLength; ++i) {
-          auto value = bitParser.read<uint32_t>(8);
-          bitBuffer.write(value, 8);
-        }
+        copyBits(bitParser, buffers.source, bitBuffer, buffers.dest, buffers.destSize,
+                 usacExtElementConfigLength * size_t{8});
 
         break;
       }
@@ -678,45 +665,42 @@ void parseAndCopyMpegh3daDecoderConfig(ilo::CBitParser& bitParser, ilo::CBitBuff
 }
 
 void parseAndCopyMpegh3daConfigExtension(ilo::CBitParser& bitParser, ilo::CBitBuffer& bitBuffer,
+                                         const SConfigBuffers& buffers,
                                          uint32_t usacConfigExtensionPresent,
                                          const ilo::ByteBuffer& mae_AudioSceneInfo) {
   if (usacConfigExtensionPresent == 0) {
     // If no extension was already present we have to create one for the ASI
-    writeEscapedValue(bitBuffer, 0 /* numConfigExtensions will be + 1 */, 2, 4, 8);
+    writeEscaped<2, 4, 8>(bitBuffer, 0 /* numConfigExtensions will be + 1 */);
   } else {
     // If extension(s) was(were) already present we have to insert the one for the ASI
-    uint32_t numConfigExtensions = static_cast<uint32_t>(readEscapedValue(bitParser, 2, 4, 8)) + 1;
-    writeEscapedValue(bitBuffer, numConfigExtensions - 1 + 1 /* +1 for the ext we add */, 2, 4, 8);
+    uint32_t numConfigExtensions = static_cast<uint32_t>(readEscaped<2, 4, 8>(bitParser)) + 1;
+    writeEscaped<2, 4, 8>(bitBuffer, numConfigExtensions - 1 + 1 /* +1 for the ext we add */);
 
     // Copy the available extensions
     for (uint32_t confExtIdx = 0; confExtIdx < numConfigExtensions; ++confExtIdx) {
-      auto usacConfigExtType = static_cast<uint32_t>(readEscapedValue(bitParser, 4, 8, 16));
-      writeEscapedValue(bitBuffer, usacConfigExtType, 4, 8, 16);
+      auto usacConfigExtType = static_cast<uint32_t>(readEscaped<4, 8, 16>(bitParser));
+      writeEscaped<4, 8, 16>(bitBuffer, usacConfigExtType);
 
       ILO_ASSERT(usacConfigExtType != 3 /* ID_CONFIG_EXT_AUDIOSCENE_INFO */,
                  "One ASI extension already present in mpegh3daConfig");
 
-      auto usacConfigExtLength = static_cast<uint32_t>(readEscapedValue(bitParser, 4, 8, 16));
-      writeEscapedValue(bitBuffer, usacConfigExtLength, 4, 8, 16);
+      auto usacConfigExtLength = static_cast<uint32_t>(readEscaped<4, 8, 16>(bitParser));
+      writeEscaped<4, 8, 16>(bitBuffer, usacConfigExtLength);
 
       // Copying usacConfigExt bytes
-      for (uint32_t i = 0; i < usacConfigExtLength; ++i) {
-        auto value = bitParser.read<uint32_t>(8);
-        bitBuffer.write(value, 8);
-      }
+      copyBits(bitParser, buffers.source, bitBuffer, buffers.dest, buffers.destSize,
+               usacConfigExtLength * size_t{8});
     }
   }
 
   // Insert the ASI extension
 
   // usacConfigExtType
-  writeEscapedValue(bitBuffer, 3 /* ID_CONFIG_EXT_AUDIOSCENE_INFO */, 4, 8, 16);
+  writeEscaped<4, 8, 16>(bitBuffer, 3 /* ID_CONFIG_EXT_AUDIOSCENE_INFO */);
   // usacConfigExtLength
-  writeEscapedValue(bitBuffer, mae_AudioSceneInfo.size(), 4, 8, 16);
+  writeEscaped<4, 8, 16>(bitBuffer, mae_AudioSceneInfo.size());
   // Copying the ASI bytes
-  for (auto info : mae_AudioSceneInfo) {
-    bitBuffer.write(info, 8);
-  }
+  writeBytes(bitBuffer, buffers.dest, buffers.destSize, mae_AudioSceneInfo);
 }
 
 ilo::CUniqueBuffer tools::insertAsiInConfig(const ilo::ByteBuffer& mpegh3daConfig,
@@ -726,9 +710,15 @@ ilo::CUniqueBuffer tools::insertAsiInConfig(const ilo::ByteBuffer& mpegh3daConfi
 
   ILO_ASSERT_WITH(begin < end, std::invalid_argument, "Invalid iterators provided (begin >= end)");
 
+  // The ASI extension adds its type and escaped length on top of the ASI bytes
+  ilo::ByteBuffer output(mpegh3daConfig.size() + mae_AudioSceneInfo.size() + 16);
+  SConfigBuffers buffers;
+  buffers.source = mpegh3daConfig.data();
+  buffers.dest = output.data();
+  buffers.destSize = output.size();
+
   ilo::CBitParser bitParser(begin, end);
-  ilo::CBitBuffer bitBuffer(
-      static_cast<uint32_t>(mpegh3daConfig.size() + mae_AudioSceneInfo.size()));
+  ilo::CBitBuffer bitBuffer(output, static_cast<uint32_t>(output.size() * 8));
 
   auto mpegh3daProfileLevelIndication = bitParser.read<uint32_t>(8);
   bitBuffer.write(mpegh3daProfileLevelIndication, 8);
@@ -757,25 +747,26 @@ ilo::CUniqueBuffer tools::insertAsiInConfig(const ilo::ByteBuffer& mpegh3daConfi
   // FrameworkConfig3d()
   parseAndCopyFrameworkConfig3d(bitParser, bitBuffer, numberOfSignals);
   // mpegh3daDecoderConfig()
-  parseAndCopyMpegh3daDecoderConfig(bitParser, bitBuffer, coreSbrFrameLengthIndex, numberOfSignals);
+  parseAndCopyMpegh3daDecoderConfig(bitParser, bitBuffer, buffers, coreSbrFrameLengthIndex,
+                                    numberOfSignals);
 
   // usacConfigExtensionPresent
   auto usacConfigExtensionPresent = bitParser.read<uint32_t>(1);
   // The extension is always present
   bitBuffer.write(1u, 1);
   // Parse / Create an mpegh3daConfigExtension()
-  parseAndCopyMpegh3daConfigExtension(bitParser, bitBuffer, usacConfigExtensionPresent,
+  parseAndCopyMpegh3daConfigExtension(bitParser, bitBuffer, buffers, usacConfigExtensionPresent,
                                       mae_AudioSceneInfo);
 
-  // Allocate new buffer from bitBuffer and return it
+  // Shrink the output to the written bytes and return it
   bitBuffer.byteAlign();
-  auto result = bitBuffer.bytebuffer();
-  return ilo::make_unique<ilo::ByteBuffer>(result.begin(), result.end());
+  output.resize(bitBuffer.tell() / 8);
+  return ilo::make_unique<ilo::ByteBuffer>(std::move(output));
 }
 
 tools::SBitstreamConfig tools::extractSampleRateAndFrameSize(
     const CMhasConfigPacket& configPacket) {
-  CMhasConfigPacket::SConfig configPacketInfo = configPacket.mhasConfigInfo();
+  const CMhasConfigPacket::SConfig& configPacketInfo = configPacket.mhasConfigInfo();
   ILO_ASSERT(configPacket.isLcProfile(), "Only LC bitstreams are supported.");
   ILO_ASSERT(configPacketInfo.outputSamplingFrequency != -1,
              "Unable to extract output sample rate.");
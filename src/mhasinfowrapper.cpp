@@ -81,7 +81,9 @@ amm-info@iis.fraunhofer.de
 -----------------------------------------------------------------------------*/
 
 // System includes
+#include <algorithm>
 #include <exception>
+#include <memory>
 
 // Internal includes
 #include "mmtmhasparserlib/mhasinfowrapper.h"
@@ -91,22 +93,45 @@ amm-info@iis.fraunhofer.de
 
 using namespace mmt::mhasparserlib;
 
+static bool isSamePayload(const ilo::ByteBuffer& previous, const SByteSpan& payload) {
+  return !previous.empty() && previous.size() == payload.size &&
+         std::equal(payload.begin(), payload.end(), previous.begin());
+}
+
 void CMhasInfoWrapper::feed(const std::vector<uint8_t>& buffer) {
   m_mhasParser.feed(buffer);
 
+  const bool wasMhasInfoAvailable = m_isMhasInfoAvailable;
+
   try {
+    const auto implausibleHeaders = m_mhasParser.errorCounters().implausibleHeaders;
     m_mhasParser.parsePackets();
+    if (m_mhasParser.errorCounters().implausibleHeaders != implausibleHeaders) {
+      m_mhasBufferInfo.wasResynced = true;
+      m_isResyncPending = true;
+    }
   } catch (const std::exception& e) {
     m_mhasParser.reset();
     m_isMhasInfoAvailable = false;
     m_seekingAsi = false;
+    m_configPayload.clear();
+    m_asiPayload.clear();
 
     m_mhasBufferInfo.wasResynced = true;
+    m_isResyncPending = true;
 
     ILO_LOG_ERROR("Error while parsing MHAS packets: %s\nResetting MHAS parser.\n", e.what());
   }
 
   handleParsedPackets();
+
+  if (m_isChanged || m_isResyncPending || wasMhasInfoAvailable != m_isMhasInfoAvailable) {
+    publishChanges();
+  }
+}
+
+void CMhasInfoWrapper::errorHandling(EErrorHandling errorHandling) {
+  m_mhasParser.errorHandling(errorHandling);
 }
 
 bool CMhasInfoWrapper::isMhasInfoAvailable() const {
@@ -122,9 +147,44 @@ CMhasInfoWrapper::SMhasBufferInfo CMhasInfoWrapper::getMhasInfo() {
   return retInfo;
 }
 
+uint64_t CMhasInfoWrapper::version() const {
+  return m_version.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<const CMhasInfoWrapper::SMhasBufferInfo> CMhasInfoWrapper::mhasInfoSnapshot()
+    const {
+  return std::atomic_load(&m_snapshot);
+}
+
+void CMhasInfoWrapper::changeCallback(CChangeCallback callback) {
+  m_changeCallback = std::move(callback);
+}
+
+void CMhasInfoWrapper::publishChanges() {
+  const uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+  m_mhasBufferInfo.version = version;
+
+  std::shared_ptr<SMhasBufferInfo> snapshot;
+  if (m_isMhasInfoAvailable) {
+    snapshot = std::make_shared<SMhasBufferInfo>(m_mhasBufferInfo);
+    snapshot->wasResynced = m_isResyncPending;
+  }
+  std::shared_ptr<const SMhasBufferInfo> constSnapshot = std::move(snapshot);
+  std::atomic_store(&m_snapshot, constSnapshot);
+  // A reader seeing the new version also gets the matching snapshot
+  m_version.store(version, std::memory_order_release);
+
+  m_isChanged = false;
+  m_isResyncPending = false;
+
+  if (m_changeCallback) {
+    m_changeCallback(constSnapshot);
+  }
+}
+
 void CMhasInfoWrapper::extractAsiInfo(const CMhasAsiPacket& mhasAsiPacket) {
   using EDataType = CMhasAsiPacket::SAudioSceneDataElement::EDataType;
-  auto audioScene = mhasAsiPacket.audioSceneInfo();
+  const auto& audioScene = mhasAsiPacket.audioSceneInfo();
 
   m_seekingAsi = false;
 
@@ -138,7 +198,7 @@ void CMhasInfoWrapper::extractAsiInfo(const CMhasAsiPacket& mhasAsiPacket) {
     switch (dataSet.dataType) {
       case EDataType::ID_MAE_GROUP_PRESET_EXTENSION: {
         const auto& presetExt =
-            dynamic_cast<CMhasAsiPacket::SAudioSceneGrpPresetEx&>(*dataSet.data);
+            dynamic_cast<const CMhasAsiPacket::SAudioSceneGrpPresetEx&>(*dataSet.data);
         handleGroupPresetExtension(presetExt, groupPresetIds);
         break;
       }
@@ -146,7 +206,7 @@ void CMhasInfoWrapper::extractAsiInfo(const CMhasAsiPacket& mhasAsiPacket) {
       case EDataType::ID_MAE_GROUP_PRESET_DESCRIPTION:
       case EDataType::ID_MAE_GROUP_DESCRIPTION: {
         const auto& audioSceneDescription =
-            dynamic_cast<CMhasAsiPacket::SAudioSceneDescription&>(*dataSet.data);
+            dynamic_cast<const CMhasAsiPacket::SAudioSceneDescription&>(*dataSet.data);
         handleGroupDescription(audioSceneDescription, dataSet.dataType);
         break;
       }
@@ -162,20 +222,23 @@ void CMhasInfoWrapper::initGroups(const CMhasAsiPacket::SAudioSceneInfo& audioSc
     SGroup groupInfo;
     groupInfo.id = group.groupID;
 
-    std::vector<uint8_t> metaDataElementIds;
+    auto addSignal = [&](uint8_t id) {
+      const CMhasConfigPacket::SSignals3d::SSignal& signal = m_signals3d.signal(id);
+      ILO_ASSERT(signal.isValid(), "Metadata element id not found.");
+
+      groupInfo.signals.push_back(signal);
+    };
+
     if (group.hasConjunctMembers) {
-      for (uint8_t id = group.startID; id < group.startID + group.bsGroupNumMembers + 1; id++) {
-        metaDataElementIds.push_back(id);
+      groupInfo.signals.reserve(group.bsGroupNumMembers + 1u);
+      for (uint32_t id = group.startID; id < group.startID + group.bsGroupNumMembers + 1u; id++) {
+        addSignal(static_cast<uint8_t>(id));
       }
     } else {
-      metaDataElementIds = group.metaDataElementId;
-    }
-
-    for (uint8_t id : metaDataElementIds) {
-      ILO_ASSERT(m_signals3d.signals.find(id) != m_signals3d.signals.end(),
-                 "Metadata element id not found.");
-
-      groupInfo.signals.push_back(m_signals3d.signals[id]);
+      groupInfo.signals.reserve(group.metaDataElementId.size());
+      for (uint8_t id : group.metaDataElementId) {
+        addSignal(id);
+      }
     }
 
     m_mhasBufferInfo.groups[groupInfo.id] = groupInfo;
@@ -306,11 +369,21 @@ void CMhasInfoWrapper::handleParsedPackets() {
     switch (static_cast<EMhasPacketType>(parsedMhasPackets->packetType())) {
       case EMhasPacketType::PACTYP_MPEGH3DACFG: {
         CMhasConfigPacket& mhasConfigPacket = dynamic_cast<CMhasConfigPacket&>(*parsedMhasPackets);
-        CMhasConfigPacket::SConfig mhasConfigInfo = mhasConfigPacket.mhasConfigInfo();
+        const SByteSpan payload = mhasConfigPacket.payloadSpan();
 
-        m_mhasBufferInfo.referenceLayout = mhasConfigInfo.referenceLayout;
-        m_mhasBufferInfo.signalGroups = mhasConfigInfo.signals3d.signalGroups;
-        m_signals3d = mhasConfigInfo.signals3d;
+        // Repeated configs are neither decoded again nor do they change the info
+        if (!isSamePayload(m_configPayload, payload)) {
+          const CMhasConfigPacket::SConfig& mhasConfigInfo = mhasConfigPacket.mhasConfigInfo();
+
+          m_mhasBufferInfo.referenceLayout = mhasConfigInfo.referenceLayout;
+          m_mhasBufferInfo.signalGroups = mhasConfigInfo.signals3d.signalGroups;
+          m_signals3d = mhasConfigInfo.signals3d;
+
+          m_configPayload.assign(payload.begin(), payload.end());
+          // The groups of the following ASI refer to the new signals
+          m_asiPayload.clear();
+          m_isChanged = true;
+        }
 
         m_seekingAsi = true;
 
@@ -318,17 +391,30 @@ void CMhasInfoWrapper::handleParsedPackets() {
       }
       case EMhasPacketType::PACTYP_AUDIOSCENEINFO: {
         CMhasAsiPacket& asiPacket = dynamic_cast<CMhasAsiPacket&>(*parsedMhasPackets);
-        extractAsiInfo(asiPacket);
+        const SByteSpan payload = asiPacket.payloadSpan();
+
+        if (isSamePayload(m_asiPayload, payload)) {
+          m_seekingAsi = false;
+        } else {
+          extractAsiInfo(asiPacket);
+
+          m_asiPayload.assign(payload.begin(), payload.end());
+          m_isChanged = true;
+        }
 
         m_isMhasInfoAvailable = true;
       } break;
       case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
         if (m_seekingAsi) {
           // There was no ASI for the previous config. Forget all info we got so far.
-
-          m_mhasBufferInfo.groups.clear();
-          m_mhasBufferInfo.groupPresets.clear();
-          m_mhasBufferInfo.switchGroups.clear();
+          if (!m_mhasBufferInfo.groups.empty() || !m_mhasBufferInfo.groupPresets.empty() ||
+              !m_mhasBufferInfo.switchGroups.empty()) {
+            m_mhasBufferInfo.groups.clear();
+            m_mhasBufferInfo.groupPresets.clear();
+            m_mhasBufferInfo.switchGroups.clear();
+            m_isChanged = true;
+          }
+          m_asiPayload.clear();
 
           m_seekingAsi = false;
         }
@@ -0,0 +1,258 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+// Internal includes
+#include "logging.h"
+#include "mmtmhasparserlib/mhasinputbuffer.h"
+
+using namespace mmt::mhasparserlib;
+
+const std::size_t CMhasInputBuffer::DEFAULT_CAPACITY = 64u * 1024u;
+
+// Number of retired slabs kept for reuse, further ones are freed once they are released
+static const std::size_t MAX_RETIRED_SLABS = 2;
+
+/*
+ * Storage block of the input buffer. The slab may outlive the buffer in parsed packets, so it keeps
+ * the memory resource alive.
+ */
+struct CMhasInputBuffer::SSlab {
+  SSlab(std::shared_ptr<CMhasMemoryResource> resource, std::size_t size)
+      : memoryResource(std::move(resource)),
+        // Intentionally not value-initialized, only bytes which have been appended are ever read
+        data(static_cast<uint8_t*>(memoryResource->allocate(size))),
+        capacity(size) {}
+  SSlab(const SSlab&) = delete;
+  SSlab& operator=(const SSlab&) = delete;
+  ~SSlab() { memoryResource->deallocate(data, capacity); }
+
+  // Whether all handles ever returned for this slab have been released
+  bool isReleased() const { return releaseCount.load(std::memory_order_acquire) == handleCount; }
+
+  const std::shared_ptr<CMhasMemoryResource> memoryResource;
+  uint8_t* const data;
+  const std::size_t capacity;
+  // Only accessed by the buffer
+  std::size_t handleCount = 0;
+  // Incremented when the last copy of a handle is destroyed, possibly on another thread
+  std::atomic<std::size_t> releaseCount{0};
+};
+
+CMhasInputBuffer::CMhasInputBuffer(std::size_t capacity,
+                                   std::shared_ptr<CMhasMemoryResource> memoryResource)
+    : m_memoryResource(memoryResource ? std::move(memoryResource)
+                                      : CMhasMemoryResource::s_defaultResource()),
+      m_slab(std::allocate_shared<SSlab>(CMhasAllocator<SSlab>(m_memoryResource), m_memoryResource,
+                                         std::max<std::size_t>(capacity, 1u))),
+      m_capacity(m_slab->capacity) {}
+
+void CMhasInputBuffer::append(const uint8_t* data, std::size_t size) {
+  if (size == 0) {
+    return;
+  }
+  ILO_ASSERT_WITH(data != nullptr, std::invalid_argument, "Invalid buffer provided (nullptr).");
+
+  if (m_size + size > m_capacity) {
+    reallocate(std::max(m_size + size, 2 * m_capacity));
+  } else if (m_sharedSize + m_size + size > m_capacity) {
+    // Consumed bytes may still be referenced by parsed packets, so the slab is retired
+    reallocate(m_capacity);
+  }
+
+  std::size_t writePos = (m_readPos + m_size) % m_capacity;
+  std::size_t firstPart = std::min(size, m_capacity - writePos);
+
+  std::copy_n(data, firstPart, m_slab->data + writePos);
+  std::copy_n(data + firstPart, size - firstPart, m_slab->data);
+  m_size += size;
+}
+
+void CMhasInputBuffer::consume(std::size_t size) {
+  ILO_ASSERT(size <= m_size, "Cannot consume more bytes than pending.");
+
+  m_size -= size;
+  if (isShared()) {
+    m_sharedSize += size;
+    m_readPos = (m_readPos + size) % m_capacity;
+    return;
+  }
+  // Restart at the beginning of the storage whenever possible to keep the pending bytes contiguous
+  m_readPos = (m_size == 0) ? 0u : (m_readPos + size) % m_capacity;
+}
+
+void CMhasInputBuffer::clear() {
+  consume(m_size);
+}
+
+void CMhasInputBuffer::reserve(std::size_t capacity) {
+  if (capacity > m_capacity) {
+    reallocate(capacity);
+  }
+}
+
+std::size_t CMhasInputBuffer::peek(std::size_t offset, uint8_t* dest, std::size_t size) const {
+  if (offset >= m_size) {
+    return 0;
+  }
+  size = std::min(size, m_size - offset);
+
+  std::size_t readPos = (m_readPos + offset) % m_capacity;
+  std::size_t firstPart = std::min(size, m_capacity - readPos);
+
+  std::copy_n(m_slab->data + readPos, firstPart, dest);
+  std::copy_n(m_slab->data, size - firstPart, dest + firstPart);
+  return size;
+}
+
+void CMhasInputBuffer::linearize(std::size_t size) {
+  ILO_ASSERT(size <= m_size, "Cannot linearize more bytes than pending.");
+
+  if (m_readPos + size <= m_capacity) {
+    return;
+  }
+
+  if (isShared()) {
+    reallocate(m_capacity);
+    return;
+  }
+
+  std::rotate(m_slab->data, m_slab->data + m_readPos, m_slab->data + m_capacity);
+  m_readPos = 0;
+}
+
+const uint8_t* CMhasInputBuffer::data() const {
+  return m_slab->data + m_readPos;
+}
+
+std::size_t CMhasInputBuffer::contiguousSize() const {
+  return std::min(m_size, m_capacity - m_readPos);
+}
+
+std::shared_ptr<const uint8_t> CMhasInputBuffer::storage() {
+  if (!m_handle) {
+    // The handle owns the slab, so its memory stays valid even if the buffer is destroyed
+    std::shared_ptr<SSlab> slab = m_slab;
+    auto deleter = [slab](const uint8_t*) {
+      slab->releaseCount.fetch_add(1, std::memory_order_release);
+    };
+    m_handle = std::shared_ptr<const uint8_t>(m_slab->data, deleter,
+                                              CMhasAllocator<uint8_t>(m_memoryResource));
+    ++m_slab->handleCount;
+  }
+  return m_handle;
+}
+
+void CMhasInputBuffer::reallocate(std::size_t capacity) {
+  std::shared_ptr<SSlab> slab = acquireSlab(capacity);
+  peek(0, slab->data, m_size);
+
+  // Slabs of another capacity are freed as soon as they are released
+  if (isShared() && m_slab->capacity == capacity) {
+    m_retiredSlabs.push_back(std::move(m_slab));
+    if (m_retiredSlabs.size() > MAX_RETIRED_SLABS) {
+      m_retiredSlabs.erase(m_retiredSlabs.begin());
+    }
+  }
+  m_handle.reset();
+  m_slab = std::move(slab);
+  m_capacity = capacity;
+  m_readPos = 0;
+  m_sharedSize = 0;
+}
+
+std::shared_ptr<CMhasInputBuffer::SSlab> CMhasInputBuffer::acquireSlab(std::size_t capacity) {
+  for (auto it = m_retiredSlabs.begin(); it != m_retiredSlabs.end(); ++it) {
+    if ((*it)->capacity == capacity && (*it)->isReleased()) {
+      std::shared_ptr<SSlab> slab = std::move(*it);
+      m_retiredSlabs.erase(it);
+      return slab;
+    }
+  }
+  return std::allocate_shared<SSlab>(CMhasAllocator<SSlab>(m_memoryResource), m_memoryResource,
+                                    capacity);
+}
@@ -127,6 +127,16 @@ CMhasMarkerPacket::CMhasMarkerPacket(uint64_t label, const ilo::ByteBuffer& mark
 CMhasMarkerPacket::CMhasMarkerPacket(ilo::ByteBuffer::const_iterator& begin,
                                      ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload();
+}
+
+CMhasMarkerPacket::CMhasMarkerPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                     std::shared_ptr<const uint8_t> payloadOwner)
+    : CMhasPacket(header, payload, std::move(payloadOwner)) {
+  initFromPayload();
+}
+
+void CMhasMarkerPacket::initFromPayload() {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_MARKER,
                   std::invalid_argument, "Invalid packet type.");
 }
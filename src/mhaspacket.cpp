@@ -86,8 +86,8 @@ amm-info@iis.fraunhofer.de
 #define _SCL_SECURE_NO_WARNINGS
 #endif
 #include <algorithm>
-#include <array>
 #include <cmath>
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -101,12 +101,14 @@ amm-info@iis.fraunhofer.de
 #include "logging.h"
 #include "mmtmhasparserlib/mhaspacket.h"
 #include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhascrc16.h"
 #include "mmtmhasparserlib/mhascrc16packet.h"
 #include "mmtmhasparserlib/mhastruncationpacket.h"
 #include "mmtmhasparserlib/mhasframepacket.h"
 #include "mmtmhasparserlib/mhassyncpacket.h"
 #include "mmtmhasparserlib/mhasasipacket.h"
 #include "mmtmhasparserlib/mhasmarkerpacket.h"
+#include "mmtmhasparserlib/mhaspacketpool.h"
 #include "mmtmhasparserlib/mhasutilities.h"
 
 using namespace mmt::mhasparserlib;
@@ -144,78 +146,84 @@ std::string mmt::mhasparserlib::packetTypeToString(EMhasPacketType packetType) {
   }
 }
 
-class CCRC16 {
- public:
-  CCRC16(uint16_t crcPolynom, uint16_t crcStartValue);
+CMhasPacket::CMhasPacket(ilo::ByteBuffer::const_iterator& begin,
+                         ilo::ByteBuffer::const_iterator end) {
+  ILO_ASSERT_WITH(begin < end, std::invalid_argument, "Invalid iterators provided (begin >= end).");
 
-  uint16_t calculateCRC(const ilo::ByteBuffer& buffer);
+  const uint8_t* data = &(*begin);
+  const auto size = static_cast<std::size_t>(end - begin);
 
- private:
-  std::array<uint16_t, 256> m_lookupTable;
-  uint16_t m_crcStartValue;
-};
+  SMhasPacketHeader header;
+  ILO_ASSERT(s_decodeHeader(data, data + size, header),
+             "Header is not completely covered by begin and end.");
+  ILO_ASSERT(size >= header.packetSize(), "Payload is not completely covered by begin and end.");
 
-CCRC16::CCRC16(uint16_t crcPolynom, uint16_t crcStartValue) : m_crcStartValue(crcStartValue) {
-  m_lookupTable.fill(0);
+  m_packetLabel = header.packetLabel;
+  m_packetType = header.packetType;
+  initPayload(data + header.headerLength, static_cast<std::size_t>(header.payloadLength), nullptr);
+  begin += static_cast<std::ptrdiff_t>(header.packetSize());
+}
 
-  for (uint16_t i = 0; i < m_lookupTable.size(); ++i) {
-    uint16_t value = static_cast<uint16_t>(i << 8u);
-    for (int8_t j = 7; j >= 0; j--) {
-      if ((value & 0x8000u) > 0) {
-        value = static_cast<uint16_t>((value << 1u) ^ crcPolynom);
-      } else {
-        value = static_cast<uint16_t>(value << 1u);
-      }
-    }
+CMhasPacket::CMhasPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                         std::shared_ptr<const uint8_t> payloadOwner)
+    : m_packetLabel(header.packetLabel), m_packetType(header.packetType) {
+  ILO_ASSERT_WITH(payload != nullptr || header.payloadLength == 0, std::invalid_argument,
+                  "Invalid payload provided (nullptr).");
 
-    m_lookupTable[i] = value;
-  }
+  initPayload(payload, static_cast<std::size_t>(header.payloadLength), std::move(payloadOwner));
 }
 
-uint16_t CCRC16::calculateCRC(const ilo::ByteBuffer& buffer) {
-  uint16_t crc = m_crcStartValue;
-
-  for (auto byte : buffer) {
-    crc = static_cast<uint16_t>((crc << 8u) ^
-                                m_lookupTable[static_cast<std::size_t>((crc >> 8u) ^ byte)]);
+void CMhasPacket::initPayload(const uint8_t* payload, std::size_t payloadLength,
+                              std::shared_ptr<const uint8_t> payloadOwner) {
+  if (payloadOwner) {
+    m_payloadOwner = std::move(payloadOwner);
+    m_sharedPayload.data = payload;
+    m_sharedPayload.size = payloadLength;
+  } else {
+    m_payload = ilo::ByteBuffer(payload, payload + payloadLength);
   }
-  return crc;
 }
 
-static uint32_t escapedValueWriteSize(uint64_t value, uint32_t first, uint32_t second,
-                                      uint32_t third) {
-  uint32_t size = first;
-  if (value >= (uint64_t{2u} << (first - 1u)) - 1u) {
-    size += second;
-    value -= (uint64_t{2u} << (first - 1u)) - 1u;
+CMhasPacket::CMhasPacket(uint32_t packetType) : m_packetLabel(1u), m_packetType(packetType) {}
 
-    if (value >= (uint64_t{2u} << (second - 1u)) - 1u) {
-      size += third;
-    }
-  }
-  return size;
+CMhasPacket::CMhasPacket(const CMhasPacket& other)
+    : m_payload(other.m_payload),
+      m_packetLabel(other.m_packetLabel),
+      m_packetType(other.m_packetType),
+      m_crcStatus(other.m_crcStatus),
+      m_payloadOwner(other.m_payloadOwner),
+      m_sharedPayload(other.m_sharedPayload) {
+  materializeBorrowedPayload();
 }
 
-CMhasPacket::CMhasPacket(ilo::ByteBuffer::const_iterator& begin,
-                         ilo::ByteBuffer::const_iterator end) {
-  ILO_ASSERT_WITH(begin < end, std::invalid_argument, "Invalid iterators provided (begin >= end).");
+CMhasPacket& CMhasPacket::operator=(const CMhasPacket& other) {
+  m_payload = other.m_payload;
+  m_packetLabel = other.m_packetLabel;
+  m_packetType = other.m_packetType;
+  m_crcStatus = other.m_crcStatus;
+  m_payloadOwner = other.m_payloadOwner;
+  m_sharedPayload = other.m_sharedPayload;
+  materializeBorrowedPayload();
+  return *this;
+}
 
-  ilo::CBitParser bitBuffer(begin, end);
-  m_packetType = static_cast<uint32_t>(readEscapedValue(bitBuffer, 3, 8, 8));
-  m_packetLabel = readEscapedValue(bitBuffer, 2, 8, 32);
-  uint64_t packetLength = readEscapedValue(bitBuffer, 11, 24, 24);
+void CMhasPacket::materializeBorrowedPayload() {
+  if (m_payloadOwner && m_payloadOwner.use_count() == 0) {
+    materializePayload();
+  }
+}
 
-  uint32_t read = bitBuffer.nofReadBits() / 8u;
-  ILO_ASSERT(static_cast<std::size_t>(end - begin) >= read + packetLength,
-             "Payload is not completely covered by begin and end.");
+CMhasPacketDeleter::CMhasPacketDeleter(std::shared_ptr<CMhasPacketPool> pool, uint32_t slot)
+    : m_pool(std::move(pool)), m_slot(slot) {}
 
-  begin += read;
-  m_payload = ilo::ByteBuffer(begin, begin + static_cast<std::ptrdiff_t>(packetLength));
-  begin += static_cast<std::ptrdiff_t>(packetLength);
+void CMhasPacketDeleter::operator()(CMhasPacket* packet) const {
+  if (m_pool) {
+    m_pool->release(packet, m_slot);
+  } else {
+    delete packet;
+  }
 }
 
-CMhasPacket::CMhasPacket(uint32_t packetType) : m_packetLabel(1u), m_packetType(packetType) {}
-
 CUniqueMhasPacket CMhasPacket::s_parseNextPacket(ilo::ByteBuffer::const_iterator& begin,
                                                  ilo::ByteBuffer::const_iterator end,
                                                  const bool audioPreRollPresent) {
@@ -224,52 +232,229 @@ CUniqueMhasPacket CMhasPacket::s_parseNextPacket(ilo::ByteBuffer::const_iterator
   }
 
   ILO_ASSERT_WITH(begin < end, std::invalid_argument, "Invalid iterators provided (begin >= end)");
-  ilo::CBitParser bitBuffer(begin, end);
 
-  EMhasPacketType packetType = {};
-  uint64_t packetLength = 0;
-
-  try {
-    packetType = static_cast<EMhasPacketType>(readEscapedValue(bitBuffer, 3, 8, 8));
+  const uint8_t* data = &(*begin);
+  const uint8_t* readPointer = data;
+  auto packet = s_parseNextPacket(readPointer, data + (end - begin), audioPreRollPresent);
+  begin += readPointer - data;
+  return packet;
+}
 
-    // Parse packet label -> will later be reparsed
-    readEscapedValue(bitBuffer, 2, 8, 32);
-    packetLength = readEscapedValue(bitBuffer, 11, 24, 24);
-  } catch (const std::exception& /*e*/) {
+CUniqueMhasPacket CMhasPacket::s_parseNextPacket(
+    const uint8_t*& begin, const uint8_t* end, const bool audioPreRollPresent,
+    const std::shared_ptr<const uint8_t>& payloadOwner) {
+  if (begin == end) {
     return nullptr;
   }
 
-  uint32_t headerLength = bitBuffer.nofReadBits() / 8u;
+  ILO_ASSERT_WITH(begin < end, std::invalid_argument, "Invalid pointers provided (begin >= end)");
 
-  std::size_t packetSize = headerLength + static_cast<std::size_t>(packetLength);
-  if (static_cast<std::size_t>(end - begin) < packetSize) {
-    return nullptr;
+  const uint8_t* readPointer = begin;
+  auto result = s_parseNextPacketWithStatus(readPointer, end, audioPreRollPresent, payloadOwner);
+  if (result.status == EParseStatus::InvalidPayload) {
+    // Create the packet again to throw the exception describing the error
+    result.packet = s_createPacket(result.header, begin + result.header.headerLength,
+                                   audioPreRollPresent, payloadOwner);
   }
 
-  switch (packetType) {
+  if (result.packet) {
+    begin = readPointer;
+  }
+  return std::move(result.packet);
+}
+
+SMhasParseResult CMhasPacket::s_parseNextPacketWithStatus(
+    const uint8_t*& begin, const uint8_t* end, const bool audioPreRollPresent,
+    const std::shared_ptr<const uint8_t>& payloadOwner, EPayloadDecoding decoding) {
+  SMhasParseResult result;
+  if (!s_decodeHeader(begin, end, result.header) ||
+      static_cast<std::size_t>(end - begin) < result.header.packetSize()) {
+    return result;
+  }
+
+  result = s_createPacketWithStatus(result.header, begin + result.header.headerLength,
+                                    audioPreRollPresent, payloadOwner, decoding);
+  begin += result.header.packetSize();
+  return result;
+}
+
+SMhasParseResult CMhasPacket::s_createPacketWithStatus(
+    const SMhasPacketHeader& header, const uint8_t* payload, const bool audioPreRollPresent,
+    const std::shared_ptr<const uint8_t>& payloadOwner, EPayloadDecoding decoding,
+    CMhasPacketPool* pool) {
+  SMhasParseResult result;
+  result.header = header;
+  result.status = EParseStatus::InvalidPayload;
+  if (!s_isValidPayload(header, payload, audioPreRollPresent)) {
+    return result;
+  }
+
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
+    case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
+      if (decoding == EPayloadDecoding::Eager) {
+        try {
+          result.packet = s_createPacket(header, payload, audioPreRollPresent, payloadOwner,
+                                         decoding, pool);
+        } catch (const std::exception&) {
+          return result;
+        }
+        break;
+      }
+      result.packet =
+          s_createPacket(header, payload, audioPreRollPresent, payloadOwner, decoding, pool);
+      break;
+    default:
+      result.packet =
+          s_createPacket(header, payload, audioPreRollPresent, payloadOwner, decoding, pool);
+      break;
+  }
+
+  result.status = EParseStatus::Ok;
+  return result;
+}
+
+bool CMhasPacket::s_isValidPayload(const SMhasPacketHeader& header, const uint8_t* payload,
+                                   const bool audioPreRollPresent) {
+  SByteSpan span;
+  span.data = payload;
+  span.size = static_cast<std::size_t>(header.payloadLength);
+
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
     case EMhasPacketType::PACTYP_CRC16:
-      return ilo::make_unique<CMhasCRC16Packet>(begin, end);
+      return CMhasCRC16Packet::s_isValidPayload(span);
     case EMhasPacketType::PACTYP_AUDIOTRUNCATION:
-      return ilo::make_unique<CMhasTruncationPacket>(begin, end);
+      return CMhasTruncationPacket::s_isValidPayload(span);
     case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
-      return ilo::make_unique<CMhasFramePacket>(begin, end, audioPreRollPresent);
+      return CMhasFramePacket::s_isValidPayload(span, audioPreRollPresent);
+    case EMhasPacketType::PACTYP_SYNC:
+      return CMhasSyncPacket::s_isValidPayload(span);
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
     case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
-      return ilo::make_unique<CMhasAsiPacket>(begin, end);
+      return !span.empty();
+    default:
+      return true;
+  }
+}
+
+CUniqueMhasPacket CMhasPacket::s_createPacket(const SMhasPacketHeader& header,
+                                              const uint8_t* payload,
+                                              const bool audioPreRollPresent,
+                                              const std::shared_ptr<const uint8_t>& payloadOwner,
+                                              EPayloadDecoding decoding, CMhasPacketPool* pool) {
+  if (pool != nullptr) {
+    return pool->createPacket(header, payload, audioPreRollPresent, payloadOwner, decoding);
+  }
+
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_CRC16:
+      return ilo::make_unique<CMhasCRC16Packet>(header, payload, payloadOwner);
+    case EMhasPacketType::PACTYP_AUDIOTRUNCATION:
+      return ilo::make_unique<CMhasTruncationPacket>(header, payload);
+    case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
+      return ilo::make_unique<CMhasFramePacket>(header, payload, audioPreRollPresent,
+                                                payloadOwner);
+    case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
+      return ilo::make_unique<CMhasAsiPacket>(header, payload, decoding);
     case EMhasPacketType::PACTYP_MPEGH3DACFG:
-      return ilo::make_unique<CMhasConfigPacket>(begin, end);
+      return ilo::make_unique<CMhasConfigPacket>(header, payload, decoding);
     case EMhasPacketType::PACTYP_SYNC:
-      return ilo::make_unique<CMhasSyncPacket>(begin, end);
+      return ilo::make_unique<CMhasSyncPacket>(header, payload, payloadOwner);
     case EMhasPacketType::PACTYP_MARKER:
-      return ilo::make_unique<CMhasMarkerPacket>(begin, end);
+      return ilo::make_unique<CMhasMarkerPacket>(header, payload, payloadOwner);
     default:
-      return ilo::make_unique<CMhasPacket>(begin, end);
+      return ilo::make_unique<CMhasPacket>(header, payload, payloadOwner);
+  }
+}
+
+bool CMhasPacket::s_decodeHeader(const uint8_t* begin, const uint8_t* end,
+                                 SMhasPacketHeader& header) {
+  ILO_ASSERT_WITH(begin <= end, std::invalid_argument, "Invalid pointers provided (end < begin).");
+
+  const auto size = static_cast<std::size_t>(end - begin);
+
+  // Fast path: packet type (3 bit), packet label (2 bit) and payload length (11 bit) are not
+  // escaped and the header fits into the first two bytes.
+  if (size >= 2) {
+    const auto value = static_cast<uint32_t>((begin[0] << 8u) | begin[1]);
+    const uint32_t packetType = value >> 13u;
+    const uint32_t packetLabel = (value >> 11u) & 0x3u;
+    const uint32_t payloadLength = value & 0x7FFu;
+
+    if (packetType < 0x7u && packetLabel < 0x3u && payloadLength < 0x7FFu) {
+      header.packetType = packetType;
+      header.packetLabel = packetLabel;
+      header.payloadLength = payloadLength;
+      header.headerLength = 2;
+      return true;
+    }
+  }
+
+  std::size_t bitPos = 0;
+  uint64_t value = 0;
+
+  if (!SEscapedValueCodec<3, 8, 8>::peek(begin, size, bitPos, value)) {
+    return false;
+  }
+  header.packetType = static_cast<uint32_t>(value);
+
+  if (!SEscapedValueCodec<2, 8, 32>::peek(begin, size, bitPos, header.packetLabel) ||
+      !SEscapedValueCodec<11, 24, 24>::peek(begin, size, bitPos, header.payloadLength)) {
+    return false;
   }
+
+  header.headerLength = bitPos / 8u;
+  return true;
+}
+
+std::size_t CMhasPacket::s_scanPackets(const uint8_t*& begin, const uint8_t* end,
+                                       SMhasPacketRecord* records, std::size_t maxRecords,
+                                       const bool audioPreRollPresent) {
+  ILO_ASSERT_WITH(begin <= end, std::invalid_argument, "Invalid pointers provided (end < begin).");
+  ILO_ASSERT_WITH(records != nullptr || maxRecords == 0, std::invalid_argument,
+                  "Invalid records provided (nullptr).");
+
+  const uint8_t* const base = begin;
+  std::size_t numRecords = 0;
+  SMhasPacketHeader header;
+  while (numRecords < maxRecords && s_decodeHeader(begin, end, header) &&
+         static_cast<std::size_t>(end - begin) >= header.packetSize()) {
+    SMhasPacketRecord& record = records[numRecords++];
+    record.offset = static_cast<uint64_t>(begin - base);
+    record.packetLabel = header.packetLabel;
+    record.payloadLength = static_cast<uint32_t>(header.payloadLength);
+    record.packetType = static_cast<uint16_t>(header.packetType);
+    record.headerLength = static_cast<uint8_t>(header.headerLength);
+    record.flags = 0;
+
+    const auto type = static_cast<EMhasPacketType>(header.packetType);
+    if (type == EMhasPacketType::PACTYP_MPEGH3DAFRAME) {
+      SByteSpan payload;
+      payload.data = begin + header.headerLength;
+      payload.size = static_cast<std::size_t>(header.payloadLength);
+      if (CMhasFramePacket::s_isIF(payload)) {
+        record.flags |= SMhasPacketRecord::FLAG_IF;
+      }
+      if (CMhasFramePacket::s_isIPF(payload, audioPreRollPresent)) {
+        record.flags |= SMhasPacketRecord::FLAG_IPF;
+      }
+    }
+
+    begin += header.packetSize();
+    if (type == EMhasPacketType::PACTYP_MPEGH3DACFG) {
+      // The config may change whether audio pre-roll is present
+      break;
+    }
+  }
+  return numRecords;
 }
 
 void CMhasPacket::payload(ilo::ByteBuffer::const_iterator begin,
                           ilo::ByteBuffer::const_iterator end) {
   ILO_ASSERT_WITH(begin <= end, std::invalid_argument, "Invalid iterators provided (end < begin).");
   m_payload = ilo::ByteBuffer(begin, end);
+  m_payloadOwner.reset();
+  m_sharedPayload = SByteSpan();
 }
 
 void CMhasPacket::packetLabel(const uint64_t label) {
@@ -280,13 +465,13 @@ std::string CMhasPacket::toString(bool dumpPayload) {
   std::stringstream stream;
 
   stream << packetTypeToString(EMhasPacketType(m_packetType)) << ", Packet-Name: " << packetName()
-         << ", Packet-Label: " << m_packetLabel << ", Payload-Length: " << m_payload.size()
-         << ", Header-Length: " << calculatePacketSize() - m_payload.size();
+         << ", Packet-Label: " << m_packetLabel << ", Payload-Length: " << payloadSpan().size
+         << ", Header-Length: " << calculatePacketSize() - payloadSpan().size;
 
   if (dumpPayload) {
     stream << ", Payload:";
 
-    for (auto byte : m_payload) {
+    for (auto byte : payloadSpan()) {
       stream << " 0x" << std::hex << static_cast<uint16_t>(byte) << std::dec;
     }
   }
@@ -323,43 +508,74 @@ void CMhasPacket::writePacket(ilo::ByteBuffer::iterator begin,
 
 std::size_t CMhasPacket::writePacket(uint8_t* rawBuffer, std::size_t rawBufferSize) const {
   std::size_t bytes = calculatePacketSize();
+  const SByteSpan payload = payloadSpan();
 
   ILO_ASSERT_WITH(bytes <= rawBufferSize, std::invalid_argument, "Provided buffer is too small.");
   ilo::CBitBuffer bitBuffer(rawBuffer, static_cast<uint32_t>(rawBufferSize));
 
-  writeEscapedValue(bitBuffer, m_packetType, 3, 8, 8);
-  writeEscapedValue(bitBuffer, m_packetLabel, 2, 8, 32);
-  writeEscapedValue(bitBuffer, m_payload.size(), 11, 24, 24);
+  writeEscaped<3, 8, 8>(bitBuffer, m_packetType);
+  writeEscaped<2, 8, 32>(bitBuffer, m_packetLabel);
+  writeEscaped<11, 24, 24>(bitBuffer, payload.size);
 
   ILO_ASSERT(bitBuffer.tell() % 8u == 0u, "Wrote invalid amount of bits.");
 
   auto* payloadStart = rawBuffer + bitBuffer.tell() / 8;
-  ILO_ASSERT(static_cast<std::size_t>(payloadStart - rawBuffer) + m_payload.size() == bytes,
+  ILO_ASSERT(static_cast<std::size_t>(payloadStart - rawBuffer) + payload.size == bytes,
              "Size calculation is wrong.");
 
-  std::copy_n(m_payload.begin(), m_payload.size(), payloadStart);
+  std::copy_n(payload.data, payload.size, payloadStart);
   return bytes;
 }
 
 uint32_t CMhasPacket::calculatePacketSize() const {
   uint64_t bits = 0u;
-  bits += escapedValueWriteSize(m_packetType, 3, 8, 8);
-  bits += escapedValueWriteSize(m_packetLabel, 2, 8, 32);
-  bits += escapedValueWriteSize(m_payload.size(), 11, 24, 24);
+  bits += escapedBits<3, 8, 8>(m_packetType);
+  bits += escapedBits<2, 8, 32>(m_packetLabel);
+  bits += escapedBits<11, 24, 24>(payloadSpan().size);
 
   ILO_ASSERT(bits % 8u == 0u, "Size calculation is wrong.");
 
-  return static_cast<uint32_t>(bits / 8u) + static_cast<uint32_t>(m_payload.size());
+  return static_cast<uint32_t>(bits / 8u) + static_cast<uint32_t>(payloadSpan().size);
 }
 
 uint16_t CMhasPacket::calculateCRC16() const {
-  static CCRC16 s_crc(0x8021u, 0xffff);
+  return CMhasCrc16::s_calculate(payloadSpan());
+}
 
-  return s_crc.calculateCRC(m_payload);
+ECrcStatus CMhasPacket::crcStatus() const {
+  return m_crcStatus;
+}
+
+void CMhasPacket::crcStatus(ECrcStatus status) {
+  m_crcStatus = status;
 }
 
 ilo::ByteBuffer CMhasPacket::payload() const {
-  return m_payload;
+  const SByteSpan payload = payloadSpan();
+  return ilo::ByteBuffer(payload.begin(), payload.end());
+}
+
+SByteSpan CMhasPacket::payloadSpan() const {
+  if (m_payloadOwner) {
+    return m_sharedPayload;
+  }
+
+  SByteSpan span;
+  span.data = m_payload.data();
+  span.size = m_payload.size();
+  return span;
+}
+
+bool CMhasPacket::isPayloadShared() const {
+  return m_payloadOwner != nullptr;
+}
+
+void CMhasPacket::materializePayload() {
+  if (m_payloadOwner) {
+    m_payload.assign(m_sharedPayload.begin(), m_sharedPayload.end());
+    m_payloadOwner.reset();
+    m_sharedPayload = SByteSpan();
+  }
 }
 
 uint32_t CMhasPacket::packetType() const {
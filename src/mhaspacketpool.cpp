@@ -0,0 +1,300 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Internal includes
+#include "logging.h"
+#include "mmtmhasparserlib/mhaspacketpool.h"
+#include "mmtmhasparserlib/mhasasipacket.h"
+#include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhascrc16packet.h"
+#include "mmtmhasparserlib/mhasframepacket.h"
+#include "mmtmhasparserlib/mhasmarkerpacket.h"
+#include "mmtmhasparserlib/mhassyncpacket.h"
+#include "mmtmhasparserlib/mhastruncationpacket.h"
+
+using namespace mmt::mhasparserlib;
+
+const std::size_t CMhasPacketPool::DEFAULT_MAX_POOLED_PER_TYPE = 64;
+
+std::shared_ptr<CMhasPacketPool> CMhasPacketPool::s_create(
+    std::size_t maxPooledPerType, std::shared_ptr<CMhasMemoryResource> memoryResource) {
+  return std::shared_ptr<CMhasPacketPool>(
+      new CMhasPacketPool(maxPooledPerType, std::move(memoryResource)));
+}
+
+CMhasPacketPool::CMhasPacketPool(std::size_t maxPooledPerType,
+                                 std::shared_ptr<CMhasMemoryResource> memoryResource)
+    : m_maxPooledPerType(maxPooledPerType),
+      m_memoryResource(memoryResource ? std::move(memoryResource)
+                                      : CMhasMemoryResource::s_defaultResource()) {
+  // Reserved upfront, so releasing a packet never needs to allocate
+  for (auto& slot : m_slots) {
+    slot.blocks.reserve(m_maxPooledPerType);
+    slot.buffers.reserve(m_maxPooledPerType);
+  }
+}
+
+CMhasPacketPool::~CMhasPacketPool() {
+  // Packets keep the pool alive, so only released packets are left
+  for (uint32_t slot = 0; slot < SlotCount; ++slot) {
+    for (void* block : m_slots[slot].blocks) {
+      m_memoryResource->deallocate(block, s_blockSize(static_cast<ESlot>(slot)));
+    }
+  }
+}
+
+template <typename TPacket, typename... TArgs>
+CUniqueMhasPacket CMhasPacketPool::construct(ESlot slot, ilo::ByteBuffer* payloadBuffer,
+                                             TArgs&&... args) {
+  // Obtained upfront, so the packet is never left without a deleter
+  CMhasPacketDeleter deleter(shared_from_this(), slot);
+  void* block = acquire(slot, payloadBuffer);
+
+  TPacket* packet = nullptr;
+  try {
+    packet = new (block) TPacket(std::forward<TArgs>(args)...);
+  } catch (...) {
+    recycle(slot, block, payloadBuffer ? std::move(*payloadBuffer) : ilo::ByteBuffer());
+    throw;
+  }
+  return CUniqueMhasPacket(packet, std::move(deleter));
+}
+
+CUniqueMhasPacket CMhasPacketPool::createPacket(const SMhasPacketHeader& header,
+                                                const uint8_t* payload,
+                                                const bool audioPreRollPresent,
+                                                const std::shared_ptr<const uint8_t>& payloadOwner,
+                                                EPayloadDecoding decoding) {
+  ILO_ASSERT_WITH(payload != nullptr || header.payloadLength == 0, std::invalid_argument,
+                  "Invalid payload provided (nullptr).");
+
+  // Packets supporting shared payloads are created on a borrowed view of the payload, which is
+  // then copied into a recycled buffer instead of a newly allocated one
+  const bool recyclePayload = !payloadOwner && header.payloadLength > 0;
+  const std::shared_ptr<const uint8_t> owner =
+      recyclePayload ? std::shared_ptr<const uint8_t>(std::shared_ptr<const uint8_t>(), payload)
+                     : payloadOwner;
+  ilo::ByteBuffer buffer;
+  ilo::ByteBuffer* payloadBuffer = recyclePayload ? &buffer : nullptr;
+
+  CUniqueMhasPacket packet;
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_AUDIOTRUNCATION:
+      return construct<CMhasTruncationPacket>(Truncation, nullptr, header, payload);
+    case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
+      return construct<CMhasAsiPacket>(Asi, nullptr, header, payload, decoding);
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
+      return construct<CMhasConfigPacket>(Config, nullptr, header, payload, decoding);
+    case EMhasPacketType::PACTYP_CRC16:
+      packet = construct<CMhasCRC16Packet>(Crc16, payloadBuffer, header, payload, owner);
+      break;
+    case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
+      packet = construct<CMhasFramePacket>(Frame, payloadBuffer, header, payload,
+                                           audioPreRollPresent, owner);
+      break;
+    case EMhasPacketType::PACTYP_SYNC:
+      packet = construct<CMhasSyncPacket>(Sync, payloadBuffer, header, payload, owner);
+      break;
+    case EMhasPacketType::PACTYP_MARKER:
+      packet = construct<CMhasMarkerPacket>(Marker, payloadBuffer, header, payload, owner);
+      break;
+    default:
+      packet = construct<CMhasPacket>(Generic, payloadBuffer, header, payload, owner);
+      break;
+  }
+
+  if (recyclePayload) {
+    buffer.clear();
+    packet->m_payload.swap(buffer);
+    packet->materializePayload();
+  }
+  return packet;
+}
+
+CMhasPacketPool::SStatistics CMhasPacketPool::statistics() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+void CMhasPacketPool::trim(std::size_t maxPooledPerType) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (uint32_t index = 0; index < SlotCount; ++index) {
+    auto& slot = m_slots[index];
+    while (slot.blocks.size() > maxPooledPerType) {
+      m_memoryResource->deallocate(slot.blocks.back(), s_blockSize(static_cast<ESlot>(index)));
+      slot.blocks.pop_back();
+      --m_statistics.pooledPackets;
+    }
+    while (slot.buffers.size() > maxPooledPerType) {
+      m_statistics.pooledPayloadCapacity -= slot.buffers.back().capacity();
+      --m_statistics.pooledPayloadBuffers;
+      slot.buffers.pop_back();
+    }
+  }
+  m_statistics.packetsInUseHighWater = m_statistics.packetsInUse;
+}
+
+void* CMhasPacketPool::acquire(ESlot slot, ilo::ByteBuffer* payloadBuffer) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& pooled = m_slots[slot];
+  if (payloadBuffer && !pooled.buffers.empty()) {
+    *payloadBuffer = std::move(pooled.buffers.back());
+    pooled.buffers.pop_back();
+    --m_statistics.pooledPayloadBuffers;
+    m_statistics.pooledPayloadCapacity -= payloadBuffer->capacity();
+  }
+
+  void* block = nullptr;
+  if (!pooled.blocks.empty()) {
+    block = pooled.blocks.back();
+    pooled.blocks.pop_back();
+    --m_statistics.pooledPackets;
+    ++m_statistics.packetReuses;
+  } else {
+    block = m_memoryResource->allocate(s_blockSize(slot));
+    ++m_statistics.packetAllocations;
+  }
+
+  ++m_statistics.packetsInUse;
+  m_statistics.packetsInUseHighWater =
+      std::max(m_statistics.packetsInUseHighWater, m_statistics.packetsInUse);
+  return block;
+}
+
+void CMhasPacketPool::recycle(ESlot slot, void* block, ilo::ByteBuffer payloadBuffer) noexcept {
+  // Config, ASI and truncation packets always copy their payload into a new buffer
+  const bool isBufferRecycled = payloadBuffer.capacity() > 0 && slot != Config && slot != Asi &&
+                                slot != Truncation;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  --m_statistics.packetsInUse;
+  auto& pooled = m_slots[slot];
+  if (pooled.blocks.size() < m_maxPooledPerType) {
+    pooled.blocks.push_back(block);
+    ++m_statistics.pooledPackets;
+  } else {
+    m_memoryResource->deallocate(block, s_blockSize(slot));
+  }
+
+  if (isBufferRecycled && pooled.buffers.size() < m_maxPooledPerType) {
+    m_statistics.pooledPayloadCapacity += payloadBuffer.capacity();
+    ++m_statistics.pooledPayloadBuffers;
+    pooled.buffers.push_back(std::move(payloadBuffer));
+  }
+}
+
+std::size_t CMhasPacketPool::s_blockSize(ESlot slot) {
+  switch (slot) {
+    case Config:
+      return sizeof(CMhasConfigPacket);
+    case Frame:
+      return sizeof(CMhasFramePacket);
+    case Asi:
+      return sizeof(CMhasAsiPacket);
+    case Sync:
+      return sizeof(CMhasSyncPacket);
+    case Marker:
+      return sizeof(CMhasMarkerPacket);
+    case Crc16:
+      return sizeof(CMhasCRC16Packet);
+    case Truncation:
+      return sizeof(CMhasTruncationPacket);
+    default:
+      return sizeof(CMhasPacket);
+  }
+}
+
+void CMhasPacketPool::release(CMhasPacket* packet, uint32_t slot) noexcept {
+  ilo::ByteBuffer buffer;
+  buffer.swap(packet->m_payload);
+
+  // The block starts at the most derived object, which is destroyed via the virtual destructor
+  void* block = dynamic_cast<void*>(packet);
+  packet->~CMhasPacket();
+  recycle(static_cast<ESlot>(slot), block, std::move(buffer));
+}
@@ -80,18 +80,207 @@ www.iis.fraunhofer.de/amm
 amm-info@iis.fraunhofer.de
 -----------------------------------------------------------------------------*/
 
+// System includes
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <stdexcept>
+
 // Internal includes
+#include "logging.h"
 #include "mmtmhasparserlib/mhasparser.h"
+#include "mmtmhasparserlib/mhasasipacket.h"
 #include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhascrc16.h"
+#include "mmtmhasparserlib/mhascrc16packet.h"
+#include "mmtmhasparserlib/mhasframepacket.h"
+#include "mmtmhasparserlib/mhasmarkerpacket.h"
+#include "mmtmhasparserlib/mhaspacketqueue.h"
+#include "mmtmhasparserlib/mhassyncpacket.h"
+#include "mmtmhasparserlib/mhastruncationpacket.h"
+#include "mhassyncscanner.h"
 
 using namespace mmt::mhasparserlib;
 
+namespace {
+// Constructs the MHAS packet of the appropriate child-type described by the given header on the
+// stack and passes it to the given consumer (see CMhasPacket::s_createPacket)
+template <typename TConsumer>
+void constructPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                     bool audioPreRollPresent, const std::shared_ptr<const uint8_t>& payloadOwner,
+                     EPayloadDecoding decoding, const TConsumer& consumer) {
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_CRC16:
+      consumer(CMhasCRC16Packet(header, payload, payloadOwner));
+      break;
+    case EMhasPacketType::PACTYP_AUDIOTRUNCATION:
+      consumer(CMhasTruncationPacket(header, payload));
+      break;
+    case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
+      consumer(CMhasFramePacket(header, payload, audioPreRollPresent, payloadOwner));
+      break;
+    case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
+      consumer(CMhasAsiPacket(header, payload, decoding));
+      break;
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
+      consumer(CMhasConfigPacket(header, payload, decoding));
+      break;
+    case EMhasPacketType::PACTYP_SYNC:
+      consumer(CMhasSyncPacket(header, payload, payloadOwner));
+      break;
+    case EMhasPacketType::PACTYP_MARKER:
+      consumer(CMhasMarkerPacket(header, payload, payloadOwner));
+      break;
+    default:
+      consumer(CMhasPacket(header, payload, payloadOwner));
+      break;
+  }
+}
+}  // namespace
+
+// Maximum size of an MHAS packet header: escapedValue(3,8,8) + escapedValue(2,8,32) +
+// escapedValue(11,24,24) = 120 bits
+static const std::size_t MAX_MHAS_HEADER_SIZE = 15;
+
+// Number of packet headers, starting with the sync packet, which need to chain consistently to
+// accept a sync packet candidate with ESyncStrategy::HeaderChain
+static const uint32_t SYNC_CONFIRMATION_DEPTH = 3;
+
+// A single header does not chain with anything, so at least two are needed to verify its length
+static const uint32_t MIN_HEADER_CHAIN_LENGTH = 2;
+
+// Initial number of bytes behind the last searched position which are linearized to search for a
+// lock position. The window grows if a header chain reaches beyond it.
+static const std::size_t SYNC_WINDOW_SIZE = 16u * 1024u;
+// Maximum number of positions with an incomplete header chain kept while synchronizing. Random data
+// leaves many of them, which must not evict actual packet boundaries.
+static const std::size_t MAX_PENDING_SYNC_POSITIONS = 1024;
+// Maximum distance of such a position to the last searched position. The bytes in between are kept
+// in the input buffer while synchronizing.
+static const std::size_t MAX_PENDING_SYNC_DISTANCE = 256u * 1024u;
+
+const uint32_t CMhasParser::DEFAULT_HEADER_CHAIN_LENGTH = 12;
+
+CMhasParser::CMhasParser() : CMhasParser(CMhasInputBuffer::DEFAULT_CAPACITY) {}
+
+CMhasParser::CMhasParser(std::size_t inputBufferCapacity,
+                         std::shared_ptr<CMhasMemoryResource> memoryResource)
+    : m_buffer(inputBufferCapacity, std::move(memoryResource)) {}
+
 void CMhasParser::feed(const ilo::ByteBuffer& vector) {
-  m_buffer.insert(m_buffer.end(), vector.begin(), vector.end());
+  copyLentBuffer();
+  m_buffer.append(vector.data(), vector.size());
 }
 
 void CMhasParser::feed(const uint8_t* rawBuffer, size_t size) {
-  m_buffer.insert(m_buffer.end(), rawBuffer, rawBuffer + size);
+  copyLentBuffer();
+  m_buffer.append(rawBuffer, size);
+}
+
+void CMhasParser::feed(std::shared_ptr<const uint8_t> data, std::size_t size) {
+  if (size == 0) {
+    return;
+  }
+  ILO_ASSERT_WITH(data != nullptr, std::invalid_argument, "Invalid buffer provided (nullptr).");
+
+  // Only a single lent buffer is kept, a previous one is copied to preserve the input order
+  copyLentBuffer();
+  m_lentBegin = data.get();
+  m_lentEnd = m_lentBegin + size;
+  m_lentBuffer = std::move(data);
+}
+
+void CMhasParser::payloadStorage(EPayloadStorage storage) {
+  m_payloadStorage = storage;
+}
+
+EPayloadStorage CMhasParser::payloadStorage() const {
+  return m_payloadStorage;
+}
+
+void CMhasParser::syncStrategy(ESyncStrategy strategy, uint32_t headerChainLength) {
+  ILO_ASSERT_WITH(headerChainLength >= MIN_HEADER_CHAIN_LENGTH, std::invalid_argument,
+                  "Invalid header chain length provided.");
+  m_syncStrategy = strategy;
+  m_headerChainLength = headerChainLength;
+  resetSyncSearch();
+}
+
+ESyncStrategy CMhasParser::syncStrategy() const {
+  return m_syncStrategy;
+}
+
+uint32_t CMhasParser::headerChainLength() const {
+  return m_headerChainLength;
+}
+
+void CMhasParser::errorHandling(EErrorHandling errorHandling) {
+  m_errorHandling = errorHandling;
+}
+
+EErrorHandling CMhasParser::errorHandling() const {
+  return m_errorHandling;
+}
+
+const SMhasParserErrorCounters& CMhasParser::errorCounters() const {
+  return m_errorCounters;
+}
+
+void CMhasParser::resetErrorCounters() {
+  m_errorCounters = SMhasParserErrorCounters();
+}
+
+void CMhasParser::crcVerification(bool enabled) {
+  m_crcVerification = enabled;
+  clearPendingCrcs();
+}
+
+bool CMhasParser::crcVerification() const {
+  return m_crcVerification;
+}
+
+const SMhasCrcCounters& CMhasParser::crcCounters() const {
+  return m_crcCounters;
+}
+
+void CMhasParser::resetCrcCounters() {
+  m_crcCounters = SMhasCrcCounters();
+}
+
+void CMhasParser::payloadDecoding(EPayloadDecoding decoding) {
+  m_payloadDecoding = decoding;
+}
+
+EPayloadDecoding CMhasParser::payloadDecoding() const {
+  return m_payloadDecoding;
+}
+
+void CMhasParser::subscriptionMask(const CMhasPacketTypeMask& mask) {
+  m_subscriptionMask = mask;
+}
+
+const CMhasPacketTypeMask& CMhasParser::subscriptionMask() const {
+  return m_subscriptionMask;
+}
+
+void CMhasParser::packetPool(std::shared_ptr<CMhasPacketPool> pool) {
+  m_packetPool = std::move(pool);
+}
+
+const std::shared_ptr<CMhasPacketPool>& CMhasParser::packetPool() const {
+  return m_packetPool;
+}
+
+void CMhasParser::outputQueue(std::shared_ptr<CMhasPacketQueue> queue) {
+  m_outputQueue = std::move(queue);
+}
+
+const std::shared_ptr<CMhasPacketQueue>& CMhasParser::outputQueue() const {
+  return m_outputQueue;
+}
+
+bool CMhasParser::isOutputBlocked() const {
+  return m_blockedPacket != nullptr;
 }
 
 uint32_t CMhasParser::numPacketsAvailable() const {
@@ -99,42 +288,437 @@ uint32_t CMhasParser::numPacketsAvailable() const {
 }
 
 uint32_t CMhasParser::numBytesPending() const {
-  return static_cast<uint32_t>(m_buffer.size());
+  return static_cast<uint32_t>(m_buffer.size() + static_cast<std::size_t>(m_lentEnd - m_lentBegin));
 }
 
 void CMhasParser::sync() {
-  m_isSynced = true;
+  if (m_syncSource == ESyncSource::None) {
+    m_syncSource = ESyncSource::Explicit;
+    resetSyncSearch();
+  }
 }
 
 bool CMhasParser::isSynced() const {
-  return m_isSynced;
+  return m_syncSource != ESyncSource::None;
+}
+
+ESyncSource CMhasParser::syncSource() const {
+  return m_syncSource;
 }
 
 void CMhasParser::reset() {
   m_buffer.clear();
+  m_lentBuffer.reset();
+  m_lentBegin = nullptr;
+  m_lentEnd = nullptr;
   m_parsedPackets.clear();
-  m_isSynced = false;
+  m_blockedPacket.reset();
+  m_syncSource = ESyncSource::None;
+  m_isResyncing = false;
+  m_incompleteScanOffset = 0;
+  resetSyncSearch();
+  clearPendingCrcs();
 }
 
 void CMhasParser::parsePackets() {
-  auto readIterator = m_buffer.cbegin();
+  if (m_blockedPacket) {
+    CUniqueMhasPacket packet = std::move(m_blockedPacket);
+    outputPacket(std::move(packet));
+  }
+
+  // Synchronization can only be lost in resilient mode, in which case the parser resynchronizes on
+  // the remaining input
+  while (!isOutputBlocked() && syncIfNecessary()) {
+    parseBufferedPackets();
+    // A blocked output may leave complete packets in the input buffer, which have to be output
+    // before any packet of the lent buffer
+    if (isSynced() && !isOutputBlocked() && m_lentBuffer &&
+        (m_buffer.empty() || completeBufferedPacket())) {
+      parseLentPackets();
+    }
+    if (isSynced()) {
+      // Unless the output is blocked, the remaining input is at most an incomplete packet
+      copyLentBuffer();
+      if (isOutputBlocked() || acceptIncompletePacket()) {
+        break;
+      }
+    }
+  }
+
+  copyLentBuffer();
+}
+
+void CMhasParser::parsePackets(const CPacketHandler& handler) {
+  // Packets left over from previous calls precede all packets parsed now
+  while (!m_parsedPackets.empty()) {
+    auto packet = std::move(m_parsedPackets.front());
+    m_parsedPackets.pop_front();
+    handler(*packet);
+  }
+  if (m_blockedPacket) {
+    CUniqueMhasPacket packet = std::move(m_blockedPacket);
+    handler(*packet);
+  }
+
+  m_packetHandler = &handler;
+  try {
+    parsePackets();
+  } catch (...) {
+    m_packetHandler = nullptr;
+    throw;
+  }
+  m_packetHandler = nullptr;
+}
+
+void CMhasParser::parseBufferedPackets() {
+  SMhasPacketHeader header;
+
+  while (!isOutputBlocked() && decodeBufferedHeader(header) && acceptHeader(header) &&
+         header.packetSize() <= m_buffer.size()) {
+    const auto packetSize = header.packetSize();
+    const uint8_t* packetBegin = m_buffer.data();
+    std::shared_ptr<const uint8_t> payloadOwner;
+    if (m_buffer.contiguousSize() < packetSize) {
+      // Only a packet wrapping around the end of the input buffer needs to be copied
+      m_wrappedPacket.resize(packetSize);
+      m_buffer.peek(0, m_wrappedPacket.data(), packetSize);
+      packetBegin = m_wrappedPacket.data();
+    } else if (m_payloadStorage == EPayloadStorage::Shared) {
+      payloadOwner = m_buffer.storage();
+    }
+
+    const uint8_t* payload = packetBegin + header.headerLength;
+    const bool isSkipped = canSkipPacket(header, payload);
+    const ECrcStatus crcStatus = verifyCrc(header, payload, isSkipped);
+    if (isSkipped) {
+      consumeBuffered(packetSize);
+      continue;
+    }
+
+    emitPacket(header, payload, std::move(payloadOwner), crcStatus);
+    consumeBuffered(packetSize);
+  }
+}
+
+void CMhasParser::parseLentPackets() {
+  std::shared_ptr<const uint8_t> payloadOwner;
+  if (m_payloadStorage == EPayloadStorage::Shared) {
+    payloadOwner = m_lentBuffer;
+  }
+
+  SMhasPacketHeader header;
+  while (!isOutputBlocked() && CMhasPacket::s_decodeHeader(m_lentBegin, m_lentEnd, header) &&
+         acceptHeader(header) &&
+         header.packetSize() <= static_cast<std::size_t>(m_lentEnd - m_lentBegin)) {
+    const uint8_t* payload = m_lentBegin + header.headerLength;
+    const bool isSkipped = canSkipPacket(header, payload);
+    const ECrcStatus crcStatus = verifyCrc(header, payload, isSkipped);
+    if (isSkipped) {
+      m_lentBegin += header.packetSize();
+      continue;
+    }
+
+    emitPacket(header, payload, payloadOwner, crcStatus);
+    m_lentBegin += header.packetSize();
+  }
+}
+
+bool CMhasParser::acceptHeader(const SMhasPacketHeader& header) {
+  if (m_errorHandling == EErrorHandling::Strict || isPlausibleHeader(header)) {
+    return true;
+  }
+
+  rejectHeader();
+  return false;
+}
+
+void CMhasParser::rejectHeader() {
+  // The header is most likely not located at a packet boundary, so its length cannot be trusted
+  ++m_errorCounters.implausibleHeaders;
+  m_syncSource = ESyncSource::None;
+  m_isResyncing = true;
+  // Packets in between might have been lost
+  clearPendingCrcs();
+}
+
+bool CMhasParser::acceptIncompletePacket() {
+  SMhasPacketHeader header;
+  if (m_errorHandling == EErrorHandling::Strict || !decodeBufferedHeader(header) ||
+      header.packetSize() <= m_buffer.size()) {
+    return true;
+  }
+
+  if (isTypicalHeader(header)) {
+    // A sync packet which starts a consistent header chain inside the declared payload reveals a
+    // corrupted length. Candidates whose chain is incomplete are checked again with more input.
+    m_buffer.linearize(m_buffer.size());
+    const uint8_t* begin = m_buffer.data();
+    const uint8_t* end = begin + m_buffer.size();
+    const uint8_t* candidate =
+        begin + std::max<std::size_t>(header.headerLength, m_incompleteScanOffset);
+    for (;; ++candidate) {
+      candidate = findSyncCandidate(candidate, end);
+      if (candidate == end) {
+        // The last bytes might be the beginning of a sync packet split between two feeds
+        m_incompleteScanOffset = m_buffer.size() - std::min<std::size_t>(m_buffer.size(), 2);
+        return true;
+      }
+      const auto result =
+          checkHeaderChain(candidate, end, SYNC_CONFIRMATION_DEPTH, false /* isLabelChecked */);
+      if (result == EHeaderChainResult::Incomplete) {
+        m_incompleteScanOffset = static_cast<std::size_t>(candidate - begin);
+        return true;
+      }
+      if (result == EHeaderChainResult::Consistent) {
+        break;
+      }
+    }
+  }
 
-  if (!syncIfNecessary(readIterator, m_buffer.end())) {
-    auto endIterator = m_buffer.begin() + (readIterator - m_buffer.cbegin());
-    m_buffer.erase(m_buffer.begin(), endIterator);
+  rejectHeader();
+  return false;
+}
+
+void CMhasParser::consumeBuffered(std::size_t size) {
+  m_buffer.consume(size);
+  m_incompleteScanOffset = 0;
+}
+
+ECrcStatus CMhasParser::verifyCrc(const SMhasPacketHeader& header, const uint8_t* payload,
+                                  bool isSkipped) {
+  if (!m_crcVerification) {
+    return ECrcStatus::NotVerified;
+  }
+
+  if (header.packetType == static_cast<uint32_t>(EMhasPacketType::PACTYP_CRC16)) {
+    if (header.payloadLength == 2) {
+      // A repeated label replaces the previous CRC, otherwise the oldest pending CRC is dropped
+      auto pending = std::find_if(
+          m_pendingCrcs.begin(), m_pendingCrcs.end(), [&](const SPendingCrc& pendingCrc) {
+            return pendingCrc.isValid && pendingCrc.packetLabel == header.packetLabel;
+          });
+      if (pending == m_pendingCrcs.end()) {
+        pending = m_pendingCrcs.begin() + static_cast<std::ptrdiff_t>(m_nextPendingCrc);
+        m_nextPendingCrc = (m_nextPendingCrc + 1u) % MAX_PENDING_CRCS;
+      }
+      pending->packetLabel = header.packetLabel;
+      pending->crc = static_cast<uint16_t>((payload[0] << 8u) | payload[1]);
+      pending->isValid = true;
+    }
+    return ECrcStatus::NotVerified;
+  }
+  if (header.packetType != static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+    // Other packets may be interleaved between a CRC16 packet and the frame it protects
+    return ECrcStatus::NotVerified;
+  }
+
+  for (auto& pending : m_pendingCrcs) {
+    if (!pending.isValid || pending.packetLabel != header.packetLabel) {
+      continue;
+    }
+    pending.isValid = false;
+    if (isSkipped) {
+      return ECrcStatus::NotVerified;
+    }
+    if (CMhasCrc16::s_update(CMhasCrc16::INITIAL_VALUE, payload,
+                             static_cast<std::size_t>(header.payloadLength)) == pending.crc) {
+      ++m_crcCounters.passed;
+      return ECrcStatus::Passed;
+    }
+    ++m_crcCounters.failed;
+    return ECrcStatus::Failed;
+  }
+
+  if (!isSkipped) {
+    ++m_crcCounters.unprotected;
+  }
+  return ECrcStatus::Unprotected;
+}
+
+void CMhasParser::clearPendingCrcs() {
+  m_pendingCrcs.fill(SPendingCrc());
+  m_nextPendingCrc = 0;
+}
+
+void CMhasParser::emitPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                             std::shared_ptr<const uint8_t> payloadOwner, ECrcStatus crcStatus) {
+  if (m_packetHandler == nullptr) {
+    auto packet = createPacket(header, payload, payloadOwner);
+    if (packet) {
+      packet->crcStatus(crcStatus);
+      addParsedPacket(std::move(packet));
+    }
     return;
   }
 
-  while (auto packet =
-             CMhasPacket::s_parseNextPacket(readIterator, m_buffer.end(), m_audioPreRollPresent)) {
-    if (packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DACFG)) {
-      m_audioPreRollPresent =
-          dynamic_cast<CMhasConfigPacket*>(packet.get())->mhasConfigInfo().audioPreRollPresent;
+  if (!payloadOwner) {
+    // The packet does not outlive the handler call, so it can borrow the payload without owning
+    // it. Copies made by the handler copy the borrowed payload.
+    payloadOwner = std::shared_ptr<const uint8_t>(std::shared_ptr<const uint8_t>(), payload);
+  }
+  visitPacket(header, payload, payloadOwner, crcStatus);
+}
+
+CUniqueMhasPacket CMhasParser::createPacket(const SMhasPacketHeader& header,
+                                            const uint8_t* payload,
+                                            const std::shared_ptr<const uint8_t>& payloadOwner) {
+  if (m_errorHandling == EErrorHandling::Strict) {
+    return CMhasPacket::s_createPacket(header, payload, m_audioPreRollPresent, payloadOwner,
+                                       m_payloadDecoding, m_packetPool.get());
+  }
+
+  auto result =
+      CMhasPacket::s_createPacketWithStatus(header, payload, m_audioPreRollPresent, payloadOwner,
+                                            m_payloadDecoding, m_packetPool.get());
+  if (!result) {
+    // The header is plausible, so the packet is skipped as a whole
+    ++m_errorCounters.invalidPayloads;
+  }
+  return std::move(result.packet);
+}
+
+void CMhasParser::visitPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                              const std::shared_ptr<const uint8_t>& payloadOwner,
+                              ECrcStatus crcStatus) {
+  const auto handle = [this, crcStatus](CMhasPacket&& packet) {
+    packet.crcStatus(crcStatus);
+    handlePacket(packet);
+  };
+  if (m_errorHandling == EErrorHandling::Strict) {
+    constructPacket(header, payload, m_audioPreRollPresent, payloadOwner, m_payloadDecoding,
+                    handle);
+    return;
+  }
+
+  if (!CMhasPacket::s_isValidPayload(header, payload, m_audioPreRollPresent)) {
+    ++m_errorCounters.invalidPayloads;
+    return;
+  }
+
+  // Decoding config and ASI payloads may still fail, which must not be confused with exceptions
+  // thrown by the packet handler
+  bool isConstructed = false;
+  try {
+    constructPacket(header, payload, m_audioPreRollPresent, payloadOwner, m_payloadDecoding,
+                    [&](CMhasPacket&& packet) {
+                      isConstructed = true;
+                      packet.crcStatus(crcStatus);
+                      handlePacket(packet);
+                    });
+  } catch (const std::exception&) {
+    if (isConstructed) {
+      throw;
     }
+    ++m_errorCounters.invalidPayloads;
+  }
+}
+
+void CMhasParser::handlePacket(const CMhasPacket& packet) {
+  if (packet.packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DACFG)) {
+    updateAudioPreRollPresent(dynamic_cast<const CMhasConfigPacket&>(packet));
+  }
+  if (m_subscriptionMask.test(packet.packetType())) {
+    (*m_packetHandler)(packet);
+  }
+}
+
+bool CMhasParser::decodeBufferedHeader(SMhasPacketHeader& header) const {
+  const uint8_t* data = m_buffer.data();
+  if (CMhasPacket::s_decodeHeader(data, data + m_buffer.contiguousSize(), header)) {
+    return true;
+  }
+  if (m_buffer.contiguousSize() == m_buffer.size()) {
+    return false;
+  }
+
+  // The header wraps around the end of the input buffer, so peek a copy of it
+  std::array<uint8_t, MAX_MHAS_HEADER_SIZE> headerBytes;
+  const auto headerSize = m_buffer.peek(0, headerBytes.data(), headerBytes.size());
+  return CMhasPacket::s_decodeHeader(headerBytes.data(), headerBytes.data() + headerSize, header);
+}
+
+bool CMhasParser::completeBufferedPacket() {
+  const auto lentSize = static_cast<std::size_t>(m_lentEnd - m_lentBegin);
+
+  // The header itself may be split between the input buffer and the lent buffer
+  std::array<uint8_t, MAX_MHAS_HEADER_SIZE> headerBytes;
+  auto headerSize = m_buffer.peek(0, headerBytes.data(), headerBytes.size());
+  const auto lentHeaderSize = std::min(headerBytes.size() - headerSize, lentSize);
+  std::copy_n(m_lentBegin, lentHeaderSize, headerBytes.data() + headerSize);
+  headerSize += lentHeaderSize;
+
+  SMhasPacketHeader header;
+  // A packet which is complete within the input buffer must be parsed from there
+  if (!CMhasPacket::s_decodeHeader(headerBytes.data(), headerBytes.data() + headerSize, header) ||
+      header.packetSize() <= m_buffer.size() || header.packetSize() > m_buffer.size() + lentSize) {
+    return false;
+  }
+
+  const auto missingSize = header.packetSize() - m_buffer.size();
+  m_buffer.append(m_lentBegin, missingSize);
+  m_lentBegin += missingSize;
+
+  parseBufferedPackets();
+  return isSynced();
+}
+
+void CMhasParser::copyLentBuffer() {
+  if (!m_lentBuffer) {
+    return;
+  }
+
+  m_buffer.append(m_lentBegin, static_cast<std::size_t>(m_lentEnd - m_lentBegin));
+  m_lentBuffer.reset();
+  m_lentBegin = nullptr;
+  m_lentEnd = nullptr;
+}
+
+bool CMhasParser::canSkipPacket(const SMhasPacketHeader& header, const uint8_t* payload) const {
+  if (m_subscriptionMask.test(header.packetType)) {
+    return false;
+  }
+  if (header.packetType != static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DACFG)) {
+    return true;
+  }
+
+  SByteSpan span;
+  span.data = payload;
+  span.size = static_cast<std::size_t>(header.payloadLength);
+  return isCurrentConfig(span);
+}
+
+bool CMhasParser::isCurrentConfig(const SByteSpan& payload) const {
+  return payload.size == m_configPayload.size() &&
+         std::equal(payload.begin(), payload.end(), m_configPayload.begin());
+}
+
+void CMhasParser::addParsedPacket(CUniqueMhasPacket packet) {
+  if (packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DACFG)) {
+    updateAudioPreRollPresent(dynamic_cast<const CMhasConfigPacket&>(*packet));
+  }
+  if (m_subscriptionMask.test(packet->packetType())) {
+    outputPacket(std::move(packet));
+  }
+}
+
+void CMhasParser::outputPacket(CUniqueMhasPacket packet) {
+  if (!m_outputQueue) {
     m_parsedPackets.push_back(std::move(packet));
+  } else if (!m_outputQueue->tryPush(packet)) {
+    // Parsing stops until the consumer made room for this packet
+    m_blockedPacket = std::move(packet);
   }
+}
 
-  m_buffer.erase(m_buffer.begin(), readIterator);
+void CMhasParser::updateAudioPreRollPresent(const CMhasConfigPacket& configPacket) {
+  // Configs are repeated with every IPF, so usually the payload is unchanged
+  const SByteSpan payload = configPacket.payloadSpan();
+  if (isCurrentConfig(payload)) {
+    return;
+  }
+
+  m_audioPreRollPresent = configPacket.mhasConfigInfo().audioPreRollPresent;
+  m_configPayload.assign(payload.begin(), payload.end());
 }
 
 CUniqueMhasPacket CMhasParser::nextPacket() {
@@ -152,16 +736,169 @@ CPacketDeque CMhasParser::allAvailablePackets() {
   return deque;
 }
 
-bool CMhasParser::syncIfNecessary(ilo::ByteBuffer::const_iterator& begin,
-                                  ilo::ByteBuffer::const_iterator end) {
-  while (!m_isSynced && end - begin > 3) {
-    if (begin[0] == 0xC0u && begin[1] == 0x01u && begin[2] == 0xA5u) {
-      m_isSynced = true;
+bool CMhasParser::syncIfNecessary() {
+  if (isSynced()) {
+    return true;
+  }
+
+  // Searching for a lock position is done in the internal input buffer only. It continues where
+  // the previous search stopped, and only the searched window needs to be contiguous.
+  copyLentBuffer();
+  std::size_t windowSize = std::min(m_buffer.size(), m_syncScanOffset + SYNC_WINDOW_SIZE);
+  for (;;) {
+    m_buffer.linearize(windowSize);
+    const uint8_t* begin = m_buffer.data();
+    if (searchLockPosition(begin, begin + windowSize, m_buffer.size())) {
+      break;
+    }
+    windowSize = std::min(m_buffer.size(), 2 * windowSize);
+  }
+
+  // Bytes in front of the lock position, or of the first position which may still become one, are
+  // dropped. Positions far behind the search cannot hold back the input buffer.
+  std::size_t skippedBytes = m_syncScanOffset;
+  if (!isSynced()) {
+    const auto isNearby = [this](const SPendingSyncPosition& pending) {
+      return m_syncScanOffset - pending.offset <= MAX_PENDING_SYNC_DISTANCE;
+    };
+    m_pendingSyncPositions.erase(
+        m_pendingSyncPositions.begin(),
+        std::find_if(m_pendingSyncPositions.begin(), m_pendingSyncPositions.end(), isNearby));
+    if (!m_pendingSyncPositions.empty()) {
+      skippedBytes = std::min(skippedBytes, m_pendingSyncPositions.front().offset);
+    }
+  }
+
+  if (m_isResyncing) {
+    m_errorCounters.skippedBytes += skippedBytes;
+    m_isResyncing = !isSynced();
+  }
+  consumeBuffered(skippedBytes);
+
+  if (isSynced()) {
+    resetSyncSearch();
+  } else {
+    m_syncScanOffset -= skippedBytes;
+    for (auto& pending : m_pendingSyncPositions) {
+      pending.offset -= skippedBytes;
+      pending.requiredEnd -= skippedBytes;
+    }
+  }
+  return isSynced();
+}
+
+bool CMhasParser::searchLockPosition(const uint8_t* begin, const uint8_t* end,
+                                     std::size_t bufferedSize) {
+  const auto windowSize = static_cast<std::size_t>(end - begin);
+  // Whether bytes needed at the given end offset are pending behind the window
+  const auto isBehindWindow = [&](std::size_t requiredEnd) {
+    return requiredEnd > windowSize && requiredEnd <= bufferedSize;
+  };
+  if (m_syncStrategy == ESyncStrategy::HeaderChain) {
+    // Positions whose header chain was incomplete before precede all positions not searched yet.
+    // They are only verified again once the bytes they wait for are available.
+    for (auto it = m_pendingSyncPositions.begin(); it != m_pendingSyncPositions.end();) {
+      if (isBehindWindow(it->requiredEnd)) {
+        return false;
+      }
+      if (it->requiredEnd > windowSize) {
+        ++it;
+        continue;
+      }
+
+      std::size_t requiredSize = 0;
+      const auto result = checkHeaderChain(begin + it->offset, end, m_headerChainLength,
+                                           true /* isLabelChecked */, &requiredSize);
+      if (result == EHeaderChainResult::Consistent) {
+        m_syncSource = ESyncSource::HeaderChain;
+        m_syncScanOffset = it->offset;
+        return true;
+      }
+      if (result == EHeaderChainResult::Inconsistent) {
+        it = m_pendingSyncPositions.erase(it);
+      } else {
+        it->requiredEnd = it->offset + requiredSize;
+      }
+    }
+  }
+
+  const uint8_t* position = begin + m_syncScanOffset;
+  for (;;) {
+    const uint8_t* searchBegin = position;
+    const uint8_t* candidate = findSyncCandidate(searchBegin, end);
+
+    if (m_syncStrategy == ESyncStrategy::HeaderChain) {
+      // Headers in front of the sync packet candidate may already chain consistently. Positions
+      // which cannot be verified yet do not stop the search, as a random length may point far
+      // beyond the available bytes.
+      for (; position < candidate; ++position) {
+        std::size_t requiredSize = 0;
+        const auto result = checkHeaderChain(position, end, m_headerChainLength,
+                                             true /* isLabelChecked */, &requiredSize);
+        if (result == EHeaderChainResult::Consistent) {
+          m_syncSource = ESyncSource::HeaderChain;
+          m_syncScanOffset = static_cast<std::size_t>(position - begin);
+          return true;
+        }
+        if (result == EHeaderChainResult::Incomplete) {
+          const auto offset = static_cast<std::size_t>(position - begin);
+          if (isBehindWindow(offset + requiredSize)) {
+            m_syncScanOffset = offset;
+            return false;
+          }
+          addPendingSyncPosition(offset, requiredSize);
+        }
+      }
+    }
+
+    if (candidate == end) {
+      // Keep the last bytes, they might be the beginning of a sync packet split between two feeds
+      position = std::max(searchBegin, end - std::min<std::ptrdiff_t>(end - searchBegin, 2));
+      m_syncScanOffset = static_cast<std::size_t>(position - begin);
+      return windowSize == bufferedSize;
+    }
+
+    if (m_syncStrategy == ESyncStrategy::SyncPacket) {
+      m_syncSource = ESyncSource::SyncPacket;
+      m_syncScanOffset = static_cast<std::size_t>(candidate - begin);
+      return true;
+    }
+
+    // The sync byte pattern may also occur inside a payload. As header chains are verified anyway,
+    // only accept it if it is followed by plausible packet headers as well. The label may change
+    // right after a sync packet, e.g. in multi-program streams.
+    std::size_t requiredSize = 0;
+    const auto result = checkHeaderChain(candidate, end, SYNC_CONFIRMATION_DEPTH,
+                                         false /* isLabelChecked */, &requiredSize);
+    if (result == EHeaderChainResult::Inconsistent) {
+      position = candidate + 1;
+      continue;
+    }
+
+    m_syncScanOffset = static_cast<std::size_t>(candidate - begin);
+    if (result == EHeaderChainResult::Consistent) {
+      m_syncSource = ESyncSource::SyncPacket;
       return true;
     }
+    return !isBehindWindow(m_syncScanOffset + requiredSize);
+  }
+}
 
-    ++begin;
+void CMhasParser::addPendingSyncPosition(std::size_t offset, std::size_t requiredSize) {
+  // The last bytes of the input buffer are searched again with the next input
+  if (!m_pendingSyncPositions.empty() && m_pendingSyncPositions.back().offset >= offset) {
+    return;
+  }
+  if (m_pendingSyncPositions.size() == MAX_PENDING_SYNC_POSITIONS) {
+    m_pendingSyncPositions.erase(m_pendingSyncPositions.begin());
   }
+  SPendingSyncPosition pending;
+  pending.offset = offset;
+  pending.requiredEnd = offset + requiredSize;
+  m_pendingSyncPositions.push_back(pending);
+}
 
-  return m_isSynced;
+void CMhasParser::resetSyncSearch() {
+  m_syncScanOffset = 0;
+  m_pendingSyncPositions.clear();
 }
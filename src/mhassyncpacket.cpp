@@ -103,12 +103,26 @@ CMhasSyncPacket::CMhasSyncPacket()
 CMhasSyncPacket::CMhasSyncPacket(ilo::ByteBuffer::const_iterator& begin,
                                  ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload();
+}
+
+CMhasSyncPacket::CMhasSyncPacket(const SMhasPacketHeader& header, const uint8_t* payload,
+                                 std::shared_ptr<const uint8_t> payloadOwner)
+    : CMhasPacket(header, payload, std::move(payloadOwner)) {
+  initFromPayload();
+}
+
+void CMhasSyncPacket::initFromPayload() {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_SYNC,
                   std::invalid_argument, "Invalid packet type.");
-  ILO_ASSERT_WITH(m_payload.size() == 1 && m_payload[0] == SYNC_PAYLOAD, std::invalid_argument,
+  ILO_ASSERT_WITH(s_isValidPayload(payloadSpan()), std::invalid_argument,
                   "Invalid payload provided.");
 }
 
+bool CMhasSyncPacket::s_isValidPayload(const SByteSpan& payload) {
+  return payload.size == 1 && payload[0] == SYNC_PAYLOAD;
+}
+
 std::string CMhasSyncPacket::packetName() const {
   return "Sync-Packet";
 }
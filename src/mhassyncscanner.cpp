@@ -0,0 +1,343 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MHAS_SYNC_SCANNER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MHAS_SYNC_SCANNER_NEON
+#include <arm_neon.h>
+#endif
+
+// Internal includes
+#include "mhassyncscanner.h"
+
+using namespace mmt::mhasparserlib;
+
+namespace {
+// Encoded MHAS sync packet: packet type 6, packet label 0, payload length 1, payload 0xA5
+const uint8_t SYNC_BYTE_0 = 0xC0u;
+const uint8_t SYNC_BYTE_1 = 0x01u;
+const uint8_t SYNC_BYTE_2 = 0xA5u;
+
+// Upper bound for payload lengths considered typical while searching for packet boundaries
+const uint64_t MAX_TYPICAL_PAYLOAD_LENGTH = 1u << 20u;
+
+// Highest packet type currently defined in the range reserved for ISO use (PACTYP_LOUDNESS)
+const uint32_t MAX_DEFINED_ISO_PACKET_TYPE = 22u;
+// First packet type of the range reserved for use outside of ISO scope
+const uint32_t FIRST_NON_ISO_PACKET_TYPE = 128u;
+
+using FindSyncCandidateFunction = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+
+struct SSyncScanner {
+  FindSyncCandidateFunction find;
+  const char* name;
+};
+
+#if defined(MHAS_SYNC_SCANNER_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MHAS_TARGET_AVX2
+uint32_t countTrailingZeros(uint32_t value) {
+  unsigned long index = 0;
+  _BitScanForward(&index, value);
+  return static_cast<uint32_t>(index);
+}
+
+bool cpuSupportsAvx2() {
+  int info[4] = {};
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6u) == 0x6u;
+  __cpuidex(info, 7, 0);
+  return osSavesYmm && (info[1] & (1 << 5)) != 0;
+}
+#else
+#define MHAS_TARGET_AVX2 __attribute__((target("avx2")))
+uint32_t countTrailingZeros(uint32_t value) {
+  return static_cast<uint32_t>(__builtin_ctz(value));
+}
+
+bool cpuSupportsAvx2() {
+  return __builtin_cpu_supports("avx2") != 0;
+}
+#endif
+
+const uint8_t* findSyncCandidateSse2(const uint8_t* begin, const uint8_t* end) {
+  const __m128i byte0 = _mm_set1_epi8(static_cast<char>(SYNC_BYTE_0));
+  const __m128i byte1 = _mm_set1_epi8(static_cast<char>(SYNC_BYTE_1));
+  const __m128i byte2 = _mm_set1_epi8(static_cast<char>(SYNC_BYTE_2));
+
+  // Compare 16 candidate positions at once, each load is shifted by one byte
+  for (; end - begin >= 16 + 2; begin += 16) {
+    const __m128i match0 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)), byte0);
+    const __m128i match1 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 1)), byte1);
+    const __m128i match2 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 2)), byte2);
+    const auto mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(match0, match1), match2)));
+    if (mask != 0) {
+      return begin + countTrailingZeros(mask);
+    }
+  }
+  return findSyncCandidateScalar(begin, end);
+}
+
+MHAS_TARGET_AVX2 const uint8_t* findSyncCandidateAvx2(const uint8_t* begin, const uint8_t* end) {
+  const __m256i byte0 = _mm256_set1_epi8(static_cast<char>(SYNC_BYTE_0));
+  const __m256i byte1 = _mm256_set1_epi8(static_cast<char>(SYNC_BYTE_1));
+  const __m256i byte2 = _mm256_set1_epi8(static_cast<char>(SYNC_BYTE_2));
+
+  // Compare 32 candidate positions at once, each load is shifted by one byte
+  for (; end - begin >= 32 + 2; begin += 32) {
+    const __m256i match0 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)), byte0);
+    const __m256i match1 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 1)), byte1);
+    const __m256i match2 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 2)), byte2);
+    const auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(match0, match1), match2)));
+    if (mask != 0) {
+      return begin + countTrailingZeros(mask);
+    }
+  }
+  return findSyncCandidateSse2(begin, end);
+}
+#endif
+
+#if defined(MHAS_SYNC_SCANNER_NEON)
+const uint8_t* findSyncCandidateNeon(const uint8_t* begin, const uint8_t* end) {
+  const uint8x16_t byte0 = vdupq_n_u8(SYNC_BYTE_0);
+  const uint8x16_t byte1 = vdupq_n_u8(SYNC_BYTE_1);
+  const uint8x16_t byte2 = vdupq_n_u8(SYNC_BYTE_2);
+
+  // Compare 16 candidate positions at once, each load is shifted by one byte
+  for (; end - begin >= 16 + 2; begin += 16) {
+    const uint8x16_t match0 = vceqq_u8(vld1q_u8(begin), byte0);
+    const uint8x16_t match1 = vceqq_u8(vld1q_u8(begin + 1), byte1);
+    const uint8x16_t match2 = vceqq_u8(vld1q_u8(begin + 2), byte2);
+    if (vmaxvq_u8(vandq_u8(vandq_u8(match0, match1), match2)) != 0) {
+      // NEON has no movemask, so locate the match within the 16 positions byte-wise
+      return findSyncCandidateScalar(begin, begin + 16 + 2);
+    }
+  }
+  return findSyncCandidateScalar(begin, end);
+}
+#endif
+
+SSyncScanner selectSyncScanner() {
+#if defined(MHAS_SYNC_SCANNER_X86)
+  if (cpuSupportsAvx2()) {
+    return {&findSyncCandidateAvx2, "AVX2"};
+  }
+  return {&findSyncCandidateSse2, "SSE2"};
+#elif defined(MHAS_SYNC_SCANNER_NEON)
+  return {&findSyncCandidateNeon, "NEON"};
+#else
+  return {&findSyncCandidateScalar, "Scalar"};
+#endif
+}
+
+const SSyncScanner& syncScanner() {
+  static const SSyncScanner scanner = selectSyncScanner();
+  return scanner;
+}
+
+// Returns whether packets of the given type do not need to be bound to an audio stream
+bool isLabelOptional(uint32_t packetType) {
+  return packetType == static_cast<uint32_t>(EMhasPacketType::PACTYP_SYNC) ||
+         packetType == static_cast<uint32_t>(EMhasPacketType::PACTYP_FILLDATA);
+}
+}  // namespace
+
+const uint8_t* mmt::mhasparserlib::findSyncCandidate(const uint8_t* begin, const uint8_t* end) {
+  return syncScanner().find(begin, end);
+}
+
+const uint8_t* mmt::mhasparserlib::findSyncCandidateScalar(const uint8_t* begin,
+                                                           const uint8_t* end) {
+  for (; end - begin >= 3; ++begin) {
+    if (begin[0] == SYNC_BYTE_0 && begin[1] == SYNC_BYTE_1 && begin[2] == SYNC_BYTE_2) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+const char* mmt::mhasparserlib::syncScannerName() {
+  return syncScanner().name;
+}
+
+bool mmt::mhasparserlib::isPlausibleHeader(const SMhasPacketHeader& header) {
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_SYNC:
+      return header.payloadLength == 1;
+    case EMhasPacketType::PACTYP_CRC16:
+    case EMhasPacketType::PACTYP_AUDIOTRUNCATION:
+      return header.payloadLength == 2;
+    default:
+      // Packets of all other types, including unknown ones, can be skipped by their length
+      return true;
+  }
+}
+
+bool mmt::mhasparserlib::isTypicalHeader(const SMhasPacketHeader& header) {
+  if (header.payloadLength > MAX_TYPICAL_PAYLOAD_LENGTH) {
+    return false;
+  }
+
+  switch (static_cast<EMhasPacketType>(header.packetType)) {
+    case EMhasPacketType::PACTYP_MPEGH3DACFG:
+    case EMhasPacketType::PACTYP_MPEGH3DAFRAME:
+    case EMhasPacketType::PACTYP_AUDIOSCENEINFO:
+      if (header.payloadLength == 0) {
+        return false;
+      }
+      break;
+    default:
+      break;
+  }
+
+  // Packet types 4 and 5 as well as the types following the defined ISO types are reserved
+  return header.packetType != 4u && header.packetType != 5u &&
+         (header.packetType <= MAX_DEFINED_ISO_PACKET_TYPE ||
+          header.packetType >= FIRST_NON_ISO_PACKET_TYPE);
+}
+
+EHeaderChainResult mmt::mhasparserlib::checkHeaderChain(const uint8_t* begin, const uint8_t* end,
+                                                        uint32_t depth, bool isLabelChecked,
+                                                        std::size_t* requiredSize) {
+  const uint8_t* const chainBegin = begin;
+  const auto incomplete = [&](std::size_t size) {
+    if (requiredSize != nullptr) {
+      *requiredSize = size;
+    }
+    return EHeaderChainResult::Incomplete;
+  };
+  SMhasPacketHeader header;
+  bool hasLabel = false;
+  uint64_t label = 0;
+
+  for (uint32_t i = 0; i < depth; ++i) {
+    if (!CMhasPacket::s_decodeHeader(begin, end, header)) {
+      return incomplete(static_cast<std::size_t>(end - chainBegin) + 1u);
+    }
+    if (!isPlausibleHeader(header) || !isTypicalHeader(header)) {
+      return EHeaderChainResult::Inconsistent;
+    }
+
+    // Packets belonging to the same audio stream share their label. Label 0 is not assigned to any
+    // audio stream, only packets not bound to an audio stream may use it.
+    if (isLabelChecked && (header.packetLabel != 0u || !isLabelOptional(header.packetType))) {
+      if (header.packetLabel == 0u || (hasLabel && header.packetLabel != label)) {
+        return EHeaderChainResult::Inconsistent;
+      }
+      hasLabel = true;
+      label = header.packetLabel;
+    }
+
+    const auto available = static_cast<std::size_t>(end - begin);
+    if (header.packetType == static_cast<uint32_t>(EMhasPacketType::PACTYP_SYNC) &&
+        available > header.headerLength && begin[header.headerLength] != SYNC_BYTE_2) {
+      return EHeaderChainResult::Inconsistent;
+    }
+
+    if (i + 1 < depth) {
+      if (available < header.packetSize()) {
+        return incomplete(static_cast<std::size_t>(begin - chainBegin) + header.packetSize());
+      }
+      begin += header.packetSize();
+    }
+  }
+  return EHeaderChainResult::Consistent;
+}
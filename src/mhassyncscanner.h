@@ -0,0 +1,153 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file mhassyncscanner.h
+ *
+ * @brief Helpers to locate MHAS sync packets and to verify MHAS packet header chains.
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+
+// Internal includes
+#include "mmtmhasparserlib/mhaspacket.h"
+
+namespace mmt {
+namespace mhasparserlib {
+//! Result of verifying a chain of consecutive MHAS packet headers
+enum class EHeaderChainResult {
+  //! All requested headers are plausible and each one starts right after the previous packet
+  Consistent,
+  //! A header is implausible or does not belong to the same audio stream as the previous ones
+  Inconsistent,
+  //! The byte range ends before all requested headers could be verified
+  Incomplete
+};
+
+/*!
+ * @brief Returns a pointer to the first occurrence of the encoded MHAS sync packet (C0 01 A5) in
+ * the given byte range or @p end if there is none.
+ *
+ * The fastest implementation supported by the CPU is selected at runtime.
+ */
+const uint8_t* findSyncCandidate(const uint8_t* begin, const uint8_t* end);
+
+//! Byte-wise reference implementation of @ref findSyncCandidate.
+const uint8_t* findSyncCandidateScalar(const uint8_t* begin, const uint8_t* end);
+
+//! Returns the name of the implementation selected by @ref findSyncCandidate.
+const char* syncScannerName();
+
+/*!
+ * @brief Returns whether the given decoded header can belong to a valid MHAS stream.
+ *
+ * Only structurally impossible headers are rejected, i.e. packet types with a fixed payload length
+ * must match it. Packets of unknown types are plausible, as they can be skipped by their length.
+ */
+bool isPlausibleHeader(const SMhasPacketHeader& header);
+
+/*!
+ * @brief Returns whether the given decoded header is typical for current MHAS streams.
+ *
+ * The packet type must not be reserved for ISO use (ISO/IEC 23008-3, 14.4), the payload must not
+ * exceed 1 MiB and config, frame and ASI packets must not be empty. Valid streams may contain
+ * other headers, so this is only a heuristic to locate packet boundaries in unsynchronized input.
+ */
+bool isTypicalHeader(const SMhasPacketHeader& header);
+
+/*!
+ * @brief Verifies that @p depth plausible and typical MHAS packet headers follow each other,
+ * starting with the header at @p begin.
+ *
+ * If @p isLabelChecked is true, all packets of the chain must carry the same non-zero label, only
+ * sync and fill data packets may use label 0 instead.
+ * Only the headers and the payloads in between need to be covered by the given byte range. If the
+ * result is @ref EHeaderChainResult::Incomplete and @p requiredSize is given, it is set to the
+ * number of bytes starting at @p begin which are needed at least to continue the verification.
+ */
+EHeaderChainResult checkHeaderChain(const uint8_t* begin, const uint8_t* end, uint32_t depth,
+                                    bool isLabelChecked, std::size_t* requiredSize = nullptr);
+}  // namespace mhasparserlib
+}  // namespace mmt
@@ -97,6 +97,16 @@ using namespace mmt::mhasparserlib;
 CMhasTruncationPacket::CMhasTruncationPacket(ilo::ByteBuffer::const_iterator& begin,
                                              ilo::ByteBuffer::const_iterator end)
     : CMhasPacket(begin, end) {
+  initFromPayload();
+}
+
+CMhasTruncationPacket::CMhasTruncationPacket(const SMhasPacketHeader& header,
+                                             const uint8_t* payload)
+    : CMhasPacket(header, payload) {
+  initFromPayload();
+}
+
+void CMhasTruncationPacket::initFromPayload() {
   ILO_ASSERT_WITH(EMhasPacketType(packetType()) == EMhasPacketType::PACTYP_AUDIOTRUNCATION,
                   std::invalid_argument, "Invalid packet type.");
   payload(m_payload.begin(), m_payload.end());
@@ -182,6 +192,11 @@ CMhasTruncationPacket::SMhasTruncationPacketConfig CMhasTruncationPacket::parseP
   return config;
 }
 
+bool CMhasTruncationPacket::s_isValidPayload(const SByteSpan& payload) {
+  // The reserved bit following the isActive flag must not be set
+  return payload.size == 2 && (payload[0] & 0x40u) == 0u;
+}
+
 void CMhasTruncationPacket::applyConfig(const SMhasTruncationPacketConfig& config) {
   setActive(config.isActive);
   truncateFromBegin(config.truncateFromBegin);
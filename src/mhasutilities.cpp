@@ -81,6 +81,8 @@ amm-info@iis.fraunhofer.de
 -----------------------------------------------------------------------------*/
 
 // System includes
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 // Internal includes
@@ -93,22 +95,7 @@ uint64_t mmt::mhasparserlib::readEscapedValue(ilo::CBitParser& bitParser, uint8_
   ILO_ASSERT(second <= 63, "Bit count for escaped value too large.");
   ILO_ASSERT(third <= 63, "Bit count for escaped value too large.");
 
-  uint64_t value = 0;
-  value = bitParser.read<uint64_t>(first);
-
-  if (value == (uint64_t(1) << first) - 1) {
-    uint64_t valueAdd = 0;
-
-    valueAdd = bitParser.read<uint64_t>(second);
-
-    value += valueAdd;
-    if (valueAdd == (uint64_t(1) << second) - 1) {
-      valueAdd = bitParser.read<uint64_t>(third);
-      value += valueAdd;
-    }
-  }
-
-  return value;
+  return SEscapedValueFormat{first, second, third}.read(bitParser);
 }
 
 void mmt::mhasparserlib::writeEscapedValue(ilo::CBitBuffer& bitBuffer, uint64_t value,
@@ -117,23 +104,89 @@ void mmt::mhasparserlib::writeEscapedValue(ilo::CBitBuffer& bitBuffer, uint64_t
   ILO_ASSERT(second <= 63, "Bit count for escaped value too large.");
   ILO_ASSERT(third <= 63, "Bit count for escaped value too large.");
 
-  if (value >= (uint64_t(1) << first) - 1) {
-    uint64_t temp = (uint64_t(1) << first) - 1;
-    bitBuffer.write(temp, first);
-    value -= temp;
-
-    if (value >= (uint64_t(1) << second) - 1) {
-      temp = (uint64_t(1) << second) - 1;
-      bitBuffer.write(temp, second);
-      value -= temp;
-
-      ILO_ASSERT_WITH(value <= (uint64_t(1) << third) - 1, std::invalid_argument,
-                      "Value to write is too big.");
-      bitBuffer.write(value, third);
-    } else {
-      bitBuffer.write(value, second);
-    }
+  SEscapedValueFormat{first, second, third}.write(bitBuffer, value);
+}
+
+void mmt::mhasparserlib::SEscapedValueFormat::s_checkThirdField(uint64_t value, uint32_t third) {
+  ILO_ASSERT_WITH(value <= (uint64_t{1} << third) - 1u, std::invalid_argument,
+                  "Value to write is too big.");
+}
+
+// Returns count (<= 8) bits starting at bit shift (< 8) of data. The second byte is only accessed
+// if the bits extend into it.
+static uint32_t peekBits(const uint8_t* data, uint32_t shift, uint32_t count) {
+  uint32_t value = uint32_t{data[0]} << 8u;
+  if (shift + count > 8u) {
+    value |= data[1];
+  }
+  return (value >> (16u - shift - count)) & ((1u << count) - 1u);
+}
+
+// Replaces count (<= 8) bits starting at bit shift (< 8) of the given byte
+static void pokeBits(uint8_t& byte, uint32_t shift, uint32_t count, uint32_t bits) {
+  const uint32_t mask = ((1u << count) - 1u) << (8u - shift - count);
+  byte = static_cast<uint8_t>((byte & ~mask) | ((bits << (8u - shift - count)) & mask));
+}
+
+static uint64_t loadBigEndian64(const uint8_t* data) {
+  return (uint64_t{data[0]} << 56u) | (uint64_t{data[1]} << 48u) | (uint64_t{data[2]} << 40u) |
+         (uint64_t{data[3]} << 32u) | (uint64_t{data[4]} << 24u) | (uint64_t{data[5]} << 16u) |
+         (uint64_t{data[6]} << 8u) | uint64_t{data[7]};
+}
+
+static void storeBigEndian64(uint8_t* data, uint64_t value) {
+  data[0] = static_cast<uint8_t>(value >> 56u);
+  data[1] = static_cast<uint8_t>(value >> 48u);
+  data[2] = static_cast<uint8_t>(value >> 40u);
+  data[3] = static_cast<uint8_t>(value >> 32u);
+  data[4] = static_cast<uint8_t>(value >> 24u);
+  data[5] = static_cast<uint8_t>(value >> 16u);
+  data[6] = static_cast<uint8_t>(value >> 8u);
+  data[7] = static_cast<uint8_t>(value);
+}
+
+void mmt::mhasparserlib::copyBits(const uint8_t* source, std::size_t sourceBitOffset,
+                                  uint8_t* dest, std::size_t destBitOffset, std::size_t numBits) {
+  if (numBits == 0) {
+    return;
+  }
+  source += sourceBitOffset / 8u;
+  dest += destBitOffset / 8u;
+  auto sourceShift = static_cast<uint32_t>(sourceBitOffset % 8u);
+  const auto destShift = static_cast<uint32_t>(destBitOffset % 8u);
+
+  // Fill up the first destination byte, so the destination is byte aligned afterwards
+  if (destShift != 0u) {
+    const auto count = static_cast<uint32_t>(std::min<std::size_t>(8u - destShift, numBits));
+    pokeBits(*dest, destShift, count, peekBits(source, sourceShift, count));
+    sourceShift += count;
+    source += sourceShift / 8u;
+    sourceShift %= 8u;
+    ++dest;
+    numBits -= count;
+  }
+
+  std::size_t numBytes = numBits / 8u;
+  if (sourceShift == 0u) {
+    std::memcpy(dest, source, numBytes);
   } else {
-    bitBuffer.write(value, first);
+    // Each destination byte combines two source bytes, which are all part of the copied range
+    const uint32_t complementShift = 8u - sourceShift;
+    std::size_t i = 0;
+    for (; i + 8u <= numBytes; i += 8u) {
+      const uint64_t word = (loadBigEndian64(source + i) << sourceShift) |
+                            (uint64_t{source[i + 8u]} >> complementShift);
+      storeBigEndian64(dest + i, word);
+    }
+    for (; i < numBytes; ++i) {
+      dest[i] =
+          static_cast<uint8_t>((source[i] << sourceShift) | (source[i + 1u] >> complementShift));
+    }
+  }
+
+  const auto remainingBits = static_cast<uint32_t>(numBits % 8u);
+  if (remainingBits != 0u) {
+    pokeBits(dest[numBytes], 0u, remainingBits,
+             peekBits(source + numBytes, sourceShift, remainingBits));
   }
 }
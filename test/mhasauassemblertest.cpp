@@ -0,0 +1,239 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasauassembler.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "mmtmhasparserlib/mhastruncationpacket.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static CPacketDeque parseStream(const CTestStream& stream) {
+  CMhasParser parser;
+  parser.feed(stream.data());
+  parser.parsePackets();
+  return parser.allAvailablePackets();
+}
+
+static std::vector<CUniqueMhasAccessUnit> assemble(const CTestStream& stream, uint32_t timescale) {
+  CMhasAuAssembler assembler(timescale);
+  assembler.addPackets(parseStream(stream));
+  std::vector<CUniqueMhasAccessUnit> accessUnits;
+  while (auto accessUnit = assembler.nextAccessUnit()) {
+    accessUnits.push_back(std::move(accessUnit));
+  }
+  MHAS_CHECK(assembler.numAccessUnitsAvailable() == 0);
+  return accessUnits;
+}
+
+// Adds a frame of the given label, preceded by a sync packet and a config if it is an IPF
+static void addFrame(CTestStream& stream, std::mt19937& random, const ilo::ByteBuffer& config,
+                     bool isIPF, uint64_t label = 1) {
+  if (isIPF) {
+    stream.add(CMhasSyncPacket());
+    stream.add(CMhasConfigPacket(label, config.begin(), config.end()));
+  }
+  const ilo::ByteBuffer payload = makeFramePayload(random, 300, isIPF);
+  stream.add(CMhasFramePacket(label, payload.begin(), payload.end(), true));
+}
+
+// Each frame forms an access unit stamped with 1024 samples at 48 kHz, minus truncated samples
+static void testTiming() {
+  std::mt19937 random(101);
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  for (uint32_t i = 0; i < 23; ++i) {
+    addFrame(stream, random, config, i % 8 == 0);
+  }
+  CMhasTruncationPacket::SMhasTruncationPacketConfig truncation;
+  truncation.isActive = true;
+  truncation.truncateFromBegin = false;
+  truncation.truncatedSamples = 100;
+  stream.add(CMhasTruncationPacket(1, truncation));
+  addFrame(stream, random, config, false);
+
+  const std::vector<CUniqueMhasAccessUnit> accessUnits = assemble(stream, 90000);
+  MHAS_CHECK(accessUnits.size() == 24);
+  std::size_t numPackets = 0;
+  for (std::size_t i = 0; i < accessUnits.size(); ++i) {
+    const SMhasAccessUnit& accessUnit = *accessUnits[i];
+    MHAS_CHECK(accessUnit.label == 1);
+    MHAS_CHECK(accessUnit.packets.size() == (i % 8 == 0 ? 3u : i == 23 ? 2u : 1u));
+    numPackets += accessUnit.packets.size();
+    MHAS_CHECK(accessUnit.hasTiming);
+    MHAS_CHECK(accessUnit.sampleRate == 48000);
+    // Repeated configs do not count as a change
+    MHAS_CHECK(accessUnit.isConfigChanged == (i == 0));
+    MHAS_CHECK(accessUnit.ptsSamples == 1024 * i);
+    MHAS_CHECK(accessUnit.pts == 1920 * i);
+    if (i < 23) {
+      MHAS_CHECK(accessUnit.truncatedSamples == 0);
+      MHAS_CHECK(accessUnit.durationSamples == 1024);
+      MHAS_CHECK(accessUnit.duration == 1920);
+    }
+  }
+  MHAS_CHECK(numPackets == stream.packets().size());
+
+  const SMhasAccessUnit& last = *accessUnits.back();
+  MHAS_CHECK(last.truncatedSamples == 100 && !last.truncateFromBegin);
+  MHAS_CHECK(last.durationSamples == 924);
+  // 924 samples are 1732.5 ticks, the fraction is carried over to the next access unit
+  MHAS_CHECK(last.duration == 1732);
+}
+
+// Timestamps in a timescale not divisible by the sample rate do not accumulate rounding errors
+static void testTimescaleRounding() {
+  std::mt19937 random(102);
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  for (uint32_t i = 0; i < 100; ++i) {
+    addFrame(stream, random, config, i % 8 == 0);
+  }
+
+  const std::vector<CUniqueMhasAccessUnit> accessUnits = assemble(stream, 44100);
+  MHAS_CHECK(accessUnits.size() == 100);
+  for (std::size_t i = 0; i < accessUnits.size(); ++i) {
+    MHAS_CHECK(accessUnits[i]->pts == 1024 * i * 44100 / 48000);
+    if (i + 1 < accessUnits.size()) {
+      MHAS_CHECK(accessUnits[i]->pts + accessUnits[i]->duration == accessUnits[i + 1]->pts);
+    }
+  }
+}
+
+// Labels are timed separately, and a new config payload is reported as a change
+static void testLabelsAndConfigChange() {
+  std::mt19937 random(103);
+  const ilo::ByteBuffer config = makeConfig();
+  ilo::ByteBuffer otherConfig = config;
+  // LC profile level 2
+  otherConfig[0] = 0x0Cu;
+  CTestStream stream;
+  for (uint32_t i = 0; i < 16; ++i) {
+    addFrame(stream, random, i < 8 ? config : otherConfig, i % 8 == 0, 1);
+    if (i < 4) {
+      addFrame(stream, random, config, i == 0, 2);
+    }
+  }
+
+  const std::vector<CUniqueMhasAccessUnit> accessUnits = assemble(stream, 48000);
+  MHAS_CHECK(accessUnits.size() == 20);
+  uint32_t numFrames[3] = {};
+  for (const auto& accessUnit : accessUnits) {
+    const uint64_t label = accessUnit->label;
+    MHAS_CHECK(label == 1 || label == 2);
+    if (label != 1 && label != 2) {
+      continue;
+    }
+    const uint32_t index = numFrames[label]++;
+    MHAS_CHECK(accessUnit->pts == 1024 * index);
+    MHAS_CHECK(accessUnit->isConfigChanged == (index == 0 || (label == 1 && index == 8)));
+    // The unlabeled sync packet belongs to the access unit of the following config
+    const bool hasSync = accessUnit->packets.front()->packetType() ==
+                         static_cast<uint32_t>(EMhasPacketType::PACTYP_SYNC);
+    MHAS_CHECK(hasSync == (index % 8 == 0));
+  }
+  MHAS_CHECK(numFrames[1] == 16 && numFrames[2] == 4);
+}
+
+static void testInvalidTimescale() {
+  MHAS_CHECK_THROWS(CMhasAuAssembler(0), std::invalid_argument);
+}
+
+int main() {
+  runTest("Timing", testTiming);
+  runTest("TimescaleRounding", testTimescaleRounding);
+  runTest("LabelsAndConfigChange", testLabelsAndConfigChange);
+  runTest("InvalidTimescale", testInvalidTimescale);
+  return testResult();
+}
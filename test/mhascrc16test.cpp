@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhascrc16.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+using EImplementation = CMhasCrc16::EImplementation;
+
+// Bit-serial reference of the MHAS CRC16
+static uint16_t crc16Reference(uint16_t crc, const uint8_t* data, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    crc = static_cast<uint16_t>(crc ^ (data[i] << 8));
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      crc = static_cast<uint16_t>((crc & 0x8000u) ? (crc << 1) ^ CMhasCrc16::POLYNOMIAL
+                                                  : (crc << 1));
+    }
+  }
+  return crc;
+}
+
+// All kernels match the reference for random lengths, alignments and start values
+static void testKernelAgreement() {
+  const EImplementation implementations[] = {EImplementation::Auto, EImplementation::Bytewise,
+                                             EImplementation::SliceBy8,
+                                             EImplementation::SliceBy16,
+                                             EImplementation::CarrylessMultiply};
+  std::cout << "carry-less multiply supported: "
+            << CMhasCrc16::s_isSupported(EImplementation::CarrylessMultiply) << std::endl;
+  MHAS_CHECK(CMhasCrc16::s_isSupported(EImplementation::Bytewise));
+  MHAS_CHECK(CMhasCrc16::s_isSupported(EImplementation::SliceBy8));
+  MHAS_CHECK(CMhasCrc16::s_isSupported(EImplementation::SliceBy16));
+
+  std::mt19937 random(71);
+  const ilo::ByteBuffer bytes = randomBytes(random, 4096 + 16);
+  for (uint32_t i = 0; i < 286; ++i) {
+    // Mostly short lengths around the block sizes of the kernels
+    const std::size_t size = i < 64 ? i : random() % (i < 200 ? 512 : 4096);
+    const uint8_t* data = bytes.data() + random() % 16;
+    const auto start = static_cast<uint16_t>(random());
+    const uint16_t expected = crc16Reference(start, data, size);
+
+    for (EImplementation implementation : implementations) {
+      if (CMhasCrc16::s_isSupported(implementation)) {
+        MHAS_CHECK(CMhasCrc16::s_update(start, data, size, implementation) == expected);
+      } else {
+        MHAS_CHECK_THROWS(CMhasCrc16::s_update(start, data, size, implementation),
+                          std::invalid_argument);
+      }
+    }
+  }
+}
+
+// Updating over consecutive ranges yields the checksum of the whole range
+static void testIncrementalUpdate() {
+  std::mt19937 random(72);
+  const ilo::ByteBuffer bytes = randomBytes(random, 3000);
+  SByteSpan whole;
+  whole.data = bytes.data();
+  whole.size = bytes.size();
+  const uint16_t expected = crc16Reference(CMhasCrc16::INITIAL_VALUE, bytes.data(), bytes.size());
+  MHAS_CHECK(CMhasCrc16::s_calculate(whole) == expected);
+
+  CMhasCrc16 crc;
+  MHAS_CHECK(crc.value() == CMhasCrc16::INITIAL_VALUE);
+  std::size_t offset = 0;
+  while (offset < bytes.size()) {
+    const std::size_t size = std::min<std::size_t>(random() % 300, bytes.size() - offset);
+    crc.update(bytes.data() + offset, size);
+    offset += size;
+  }
+  MHAS_CHECK(crc.value() == expected);
+
+  crc.reset();
+  crc.update(whole);
+  MHAS_CHECK(crc.value() == expected);
+}
+
+int main() {
+  runTest("KernelAgreement", testKernelAgreement);
+  runTest("IncrementalUpdate", testIncrementalUpdate);
+  return testResult();
+}
@@ -0,0 +1,253 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasasipacket.h"
+#include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhasdecodecache.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Interns the given payload as an int holding its first byte and counts the decodes
+static std::shared_ptr<const int> intern(CMhasDecodeCache& cache, uint32_t packetType,
+                                         const ilo::ByteBuffer& payload, uint32_t& numDecodes) {
+  return cache.intern<int>(packetType, payload, [&payload, &numDecodes]() {
+    ++numDecodes;
+    return std::make_shared<const int>(payload.empty() ? -1 : payload[0]);
+  });
+}
+
+// Equal payloads of the same packet type share a single decoded structure
+static void testIntern() {
+  CMhasDecodeCache cache(4);
+  const ilo::ByteBuffer first = {1, 2, 3};
+  const ilo::ByteBuffer second = {1, 2, 4};
+  uint32_t numDecodes = 0;
+
+  const std::shared_ptr<const int> decoded = intern(cache, 1, first, numDecodes);
+  MHAS_CHECK(*decoded == 1);
+  MHAS_CHECK(intern(cache, 1, ilo::ByteBuffer(first), numDecodes) == decoded);
+  MHAS_CHECK(numDecodes == 1);
+
+  MHAS_CHECK(intern(cache, 1, second, numDecodes) != decoded);
+  MHAS_CHECK(intern(cache, 14, first, numDecodes) != decoded);
+  MHAS_CHECK(numDecodes == 3);
+
+  CMhasDecodeCache::SStatistics statistics = cache.statistics();
+  MHAS_CHECK(statistics.hits == 1);
+  MHAS_CHECK(statistics.misses == 3);
+  MHAS_CHECK(statistics.entries == 3);
+  MHAS_CHECK(statistics.payloadBytes == 9);
+
+  // Cleared entries stay valid for their users
+  cache.clear();
+  MHAS_CHECK(cache.statistics().entries == 0);
+  MHAS_CHECK(*decoded == 1);
+  MHAS_CHECK(intern(cache, 1, first, numDecodes) != decoded);
+  MHAS_CHECK(numDecodes == 4);
+}
+
+// The least recently used entries are evicted beyond the maximum number of entries or bytes, and
+// payloads larger than the byte limit are not cached at all
+static void testEviction() {
+  CMhasDecodeCache cache(2, 10);
+  const ilo::ByteBuffer first(4, 1);
+  const ilo::ByteBuffer second(4, 2);
+  const ilo::ByteBuffer third(4, 3);
+  uint32_t numDecodes = 0;
+
+  intern(cache, 1, first, numDecodes);
+  intern(cache, 1, second, numDecodes);
+  intern(cache, 1, first, numDecodes);
+  intern(cache, 1, third, numDecodes);
+  MHAS_CHECK(numDecodes == 3);
+  MHAS_CHECK(cache.statistics().evictions == 1);
+
+  // The second payload was the least recently used one
+  intern(cache, 1, first, numDecodes);
+  MHAS_CHECK(numDecodes == 3);
+  intern(cache, 1, second, numDecodes);
+  MHAS_CHECK(numDecodes == 4);
+
+  // Only the most recently used entry of 4 bytes fits next to 6 more bytes
+  cache.maxEntries(4);
+  intern(cache, 1, ilo::ByteBuffer(6, 4), numDecodes);
+  CMhasDecodeCache::SStatistics statistics = cache.statistics();
+  MHAS_CHECK(statistics.entries == 2);
+  MHAS_CHECK(statistics.payloadBytes == 10);
+  MHAS_CHECK(statistics.evictions == 3);
+  intern(cache, 1, second, numDecodes);
+  MHAS_CHECK(numDecodes == 5);
+
+  const ilo::ByteBuffer large(11, 5);
+  intern(cache, 1, large, numDecodes);
+  intern(cache, 1, large, numDecodes);
+  MHAS_CHECK(numDecodes == 7);
+  MHAS_CHECK(cache.statistics().entries == 2);
+
+  // Lowering the limits evicts the least recently used entries
+  cache.maxPayloadBytes(5);
+  MHAS_CHECK(cache.statistics().entries == 1);
+  MHAS_CHECK(cache.statistics().payloadBytes == 4);
+  cache.maxEntries(0);
+  MHAS_CHECK(cache.statistics().entries == 0);
+}
+
+// A disabled cache decodes every payload and a failed decode caches nothing
+static void testDisabledAndFailedDecode() {
+  CMhasDecodeCache cache;
+  const ilo::ByteBuffer payload = {1};
+  uint32_t numDecodes = 0;
+  MHAS_CHECK(intern(cache, 1, payload, numDecodes) != intern(cache, 1, payload, numDecodes));
+  MHAS_CHECK(numDecodes == 2);
+  MHAS_CHECK(cache.statistics().entries == 0);
+
+  cache.maxEntries(4);
+  MHAS_CHECK_THROWS(cache.intern<int>(1, payload,
+                                      []() -> std::shared_ptr<const int> {
+                                        throw std::runtime_error("invalid payload");
+                                      }),
+                    std::runtime_error);
+  MHAS_CHECK(cache.statistics().entries == 0);
+  intern(cache, 1, payload, numDecodes);
+  MHAS_CHECK(numDecodes == 3);
+}
+
+// Parses the packets of the given stream
+static CPacketDeque parsePackets(const CTestStream& stream) {
+  CPacketDeque packets;
+  auto begin = stream.data().begin();
+  while (begin != stream.data().end()) {
+    packets.push_back(CMhasPacket::s_parseNextPacket(begin, stream.data().end(), true));
+  }
+  return packets;
+}
+
+// With the global cache enabled, parsed packets with equal payloads share their decoded structures
+static void testGlobalCache() {
+  const ilo::ByteBuffer config = makeConfig();
+  const ilo::ByteBuffer asi = {0x05u, 0x14u};
+  CTestStream stream;
+  for (uint64_t label : {1u, 2u}) {
+    stream.add(CMhasConfigPacket(label, config.begin(), config.end()));
+    stream.add(CMhasAsiPacket(label, asi.begin(), asi.end()));
+  }
+
+  CMhasDecodeCache& cache = CMhasDecodeCache::s_global();
+  cache.maxEntries(8);
+  cache.resetStatistics();
+  const CPacketDeque cached = parsePackets(stream);
+  MHAS_CHECK(cache.statistics().hits == 2);
+  MHAS_CHECK(cache.statistics().misses == 2);
+  const auto& firstConfig = static_cast<const CMhasConfigPacket&>(*cached[0]);
+  const auto& secondConfig = static_cast<const CMhasConfigPacket&>(*cached[2]);
+  MHAS_CHECK(firstConfig.mhasConfigSnapshot() == secondConfig.mhasConfigSnapshot());
+  const auto& firstAsi = static_cast<const CMhasAsiPacket&>(*cached[1]);
+  const auto& secondAsi = static_cast<const CMhasAsiPacket&>(*cached[3]);
+  MHAS_CHECK(firstAsi.audioSceneInfoSnapshot() == secondAsi.audioSceneInfoSnapshot());
+
+  cache.maxEntries(0);
+  MHAS_CHECK(cache.statistics().entries == 0);
+  const CPacketDeque uncached = parsePackets(stream);
+  const auto& uncachedConfig = static_cast<const CMhasConfigPacket&>(*uncached[2]);
+  MHAS_CHECK(uncachedConfig.mhasConfigSnapshot() != firstConfig.mhasConfigSnapshot());
+  MHAS_CHECK(uncachedConfig.mhasConfigInfo().audioPreRollPresent ==
+             firstConfig.mhasConfigInfo().audioPreRollPresent);
+}
+
+int main() {
+  runTest("Intern", testIntern);
+  runTest("Eviction", testEviction);
+  runTest("DisabledAndFailedDecode", testDisabledAndFailedDecode);
+  runTest("GlobalCache", testGlobalCache);
+  return testResult();
+}
@@ -0,0 +1,201 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasframereader.h"
+#include "mmtmhasparserlib/mhashelpertools.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static bool isFrame(const CUniqueMhasPacket& packet) {
+  return packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME);
+}
+
+// Checks that the given packets are a single frame, i.e. only the last packet is a frame packet
+static bool isSingleFrame(const CPacketDeque& frame) {
+  return !frame.empty() && isFrame(frame.back()) &&
+         std::none_of(frame.begin(), frame.end() - 1, isFrame);
+}
+
+static uint64_t packetsSize(const CPacketDeque& packets) {
+  uint64_t size = 0;
+  for (const auto& packet : packets) {
+    size += packet->calculatePacketSize();
+  }
+  return size;
+}
+
+// Frames read from a buffer match the stream and the position follows the returned packets
+static void testReadBuffer() {
+  // Frames larger and smaller than the read size
+  const CTestStream stream = makeTestStream(60, 91, 3 * CMhasFrameReader::DEFAULT_READ_SIZE);
+  CMhasFrameReader reader(stream.data().data(), stream.data().size());
+  reader.parser().sync();
+
+  std::size_t numPackets = 0;
+  uint64_t position = 0;
+  while (true) {
+    CPacketDeque frame = reader.nextFrame();
+    if (frame.empty()) {
+      break;
+    }
+    MHAS_CHECK(isSingleFrame(frame));
+    MHAS_CHECK(matchesPackets(frame, stream, numPackets));
+    numPackets += frame.size();
+    position += packetsSize(frame);
+    MHAS_CHECK(reader.position() == position);
+  }
+
+  MHAS_CHECK(numPackets == stream.packets().size());
+  MHAS_CHECK(reader.position() == stream.data().size());
+}
+
+// Frames split between fed buffers are returned once they are complete
+static void testReadFedBuffers() {
+  const CTestStream stream = makeTestStream(60, 92);
+  std::mt19937 random(93);
+  CMhasFrameReader reader;
+  reader.parser().sync();
+
+  std::size_t numPackets = 0;
+  std::size_t offset = 0;
+  while (offset < stream.data().size()) {
+    const std::size_t size =
+        std::min<std::size_t>(1 + random() % 700, stream.data().size() - offset);
+    reader.feed(stream.data().data() + offset, size);
+    offset += size;
+
+    while (true) {
+      CPacketDeque frame = reader.nextFrame();
+      if (frame.empty()) {
+        break;
+      }
+      MHAS_CHECK(isSingleFrame(frame));
+      MHAS_CHECK(matchesPackets(frame, stream, numPackets));
+      numPackets += frame.size();
+      MHAS_CHECK(reader.position() <= offset);
+    }
+  }
+
+  MHAS_CHECK(numPackets == stream.packets().size());
+  MHAS_CHECK(reader.position() == stream.data().size());
+}
+
+// readNextFrame returns one frame per call and advances the iterator past it
+static void testReadNextFrame() {
+  const CTestStream stream = makeTestStream(30, 94);
+  auto begin = stream.data().cbegin();
+  const auto end = stream.data().cend();
+
+  std::size_t numPackets = 0;
+  while (begin != end) {
+    const auto previous = begin;
+    const CPacketDeque frame = tools::readNextFrame(begin, end);
+    MHAS_CHECK(isSingleFrame(frame));
+    MHAS_CHECK(matchesPackets(frame, stream, numPackets));
+    MHAS_CHECK(static_cast<uint64_t>(begin - previous) == packetsSize(frame));
+    numPackets += frame.size();
+    if (frame.empty()) {
+      break;
+    }
+  }
+
+  MHAS_CHECK(numPackets == stream.packets().size());
+  MHAS_CHECK(tools::readNextFrame(begin, end).empty());
+}
+
+int main() {
+  runTest("ReadBuffer", testReadBuffer);
+  runTest("ReadFedBuffers", testReadFedBuffers);
+  runTest("ReadNextFrame", testReadNextFrame);
+  return testResult();
+}
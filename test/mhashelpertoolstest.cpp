@@ -0,0 +1,225 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <exception>
+#include <random>
+
+// External includes
+#include "ilo/bitbuffer.h"
+#include "ilo/bitparser.h"
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasframepacket.h"
+#include "mmtmhasparserlib/mhashelpertools.h"
+#include "mmtmhasparserlib/mhasutilities.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static bool bitAt(const uint8_t* data, std::size_t position) {
+  return ((data[position / 8] >> (7 - position % 8)) & 1u) != 0;
+}
+
+static void setBit(uint8_t* data, std::size_t position, bool value) {
+  const auto mask = static_cast<uint8_t>(0x80u >> (position % 8));
+  data[position / 8] = static_cast<uint8_t>(value ? data[position / 8] | mask
+                                                  : data[position / 8] & ~mask);
+}
+
+// Copies bits one at a time
+static void copyBitsReference(const uint8_t* source, std::size_t sourceBitOffset, uint8_t* dest,
+                              std::size_t destBitOffset, std::size_t numBits) {
+  for (std::size_t i = 0; i < numBits; ++i) {
+    setBit(dest, destBitOffset + i, bitAt(source, sourceBitOffset + i));
+  }
+}
+
+// Returns whether @p numBits bits of both buffers at the given bit offsets are equal
+static bool equalBits(const uint8_t* first, std::size_t firstBitOffset, const uint8_t* second,
+                      std::size_t secondBitOffset, std::size_t numBits) {
+  for (std::size_t i = 0; i < numBits; ++i) {
+    if (bitAt(first, firstBitOffset + i) != bitAt(second, secondBitOffset + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The bulk copy matches the per-bit reference for all offset combinations. Source and destination
+// have exactly the size of the copied range, so reads or writes beyond it are caught by ASan.
+static void testCopyBits() {
+  std::mt19937 random(81);
+  for (uint32_t i = 0; i < 2000; ++i) {
+    const std::size_t sourceBitOffset = random() % 70;
+    const std::size_t destBitOffset = random() % 70;
+    const std::size_t numBits = i < 200 ? i : random() % 4000;
+
+    const ilo::ByteBuffer source = randomBytes(random, (sourceBitOffset + numBits + 7) / 8);
+    ilo::ByteBuffer dest = randomBytes(random, (destBitOffset + numBits + 7) / 8);
+    ilo::ByteBuffer expected = dest;
+    copyBitsReference(source.data(), sourceBitOffset, expected.data(), destBitOffset, numBits);
+
+    copyBits(source.data(), sourceBitOffset, dest.data(), destBitOffset, numBits);
+    MHAS_CHECK(dest == expected);
+  }
+}
+
+// The ASI is appended as the only config extension and all other bits are kept
+static void testInsertAsiInConfig() {
+  std::mt19937 random(82);
+  std::size_t numBits = 0;
+  const ilo::ByteBuffer config = makeConfig(true, &numBits);
+  const ilo::ByteBuffer asi = randomBytes(random, 300);
+
+  const ilo::CUniqueBuffer result = tools::insertAsiInConfig(config, asi);
+
+  // The config up to usacConfigExtensionPresent, followed by a single ASI extension
+  ilo::ByteBuffer expected(config.size() + asi.size() + 16, 0);
+  copyBitsReference(config.data(), 0, expected.data(), 0, numBits - 1);
+  ilo::CBitBuffer bitBuffer(expected, static_cast<uint32_t>(expected.size() * 8));
+  bitBuffer.seek(static_cast<int32_t>(numBits - 1), ilo::EPosType::begin);
+  bitBuffer.write(1u, 1);
+  writeEscaped<2, 4, 8>(bitBuffer, 0);
+  writeEscaped<4, 8, 16>(bitBuffer, 3);
+  writeEscaped<4, 8, 16>(bitBuffer, asi.size());
+  for (uint8_t byte : asi) {
+    bitBuffer.write(byte, 8);
+  }
+  expected.resize((bitBuffer.tell() + 7) / 8);
+  MHAS_CHECK(*result == expected);
+
+  // A config may only carry a single ASI
+  MHAS_CHECK_THROWS(tools::insertAsiInConfig(*result, asi), std::exception);
+}
+
+// The config is written into the empty AudioPreRoll of an IPF and the rest of the frame is moved
+// behind it unchanged
+static void testEmbedConfigurationIntoPreRoll() {
+  std::mt19937 random(83);
+  // The AudioPreRoll holds configs of up to 285 bytes
+  for (std::size_t configSize : {7u, 254u, 285u}) {
+    const ilo::ByteBuffer original = makeFramePayload(random, 2000, true);
+    const ilo::ByteBuffer config = randomBytes(random, configSize);
+    ilo::ByteBuffer au = original;
+    tools::embedConfigurationIntoPreRoll(au, config);
+
+    ilo::CBitParser bitParser(au);
+    MHAS_CHECK(bitParser.read<uint32_t>(3) == 0x06u);
+    std::size_t payloadLength = bitParser.read<uint32_t>(8);
+    if (payloadLength == 255) {
+      payloadLength += bitParser.read<uint32_t>(16) - 2;
+    }
+    const std::size_t payloadStart = bitParser.tell();
+    MHAS_CHECK((readEscaped<4, 4, 8>(bitParser) == configSize));
+    MHAS_CHECK(equalBits(au.data(), bitParser.tell(), config.data(), 0, configSize * 8));
+    bitParser.seek(static_cast<int32_t>(configSize * 8), ilo::EPosType::cur);
+    // applyCrossfade, reserved and numPreRollFrames
+    MHAS_CHECK(bitParser.read<uint32_t>(2) == 0);
+    MHAS_CHECK((readEscaped<2, 4, 0>(bitParser) == 0));
+    MHAS_CHECK(bitParser.tell() <= payloadStart + payloadLength * 8);
+
+    // The original frame continues after its one byte AudioPreRoll at bit 19
+    const std::size_t restStart = payloadStart + payloadLength * 8;
+    const std::size_t restBits = original.size() * 8 - 19;
+    MHAS_CHECK((restStart + restBits + 7) / 8 == au.size());
+    MHAS_CHECK(equalBits(au.data(), restStart, original.data(), 19, restBits));
+
+    // The packet overload rewrites the payload the same way
+    CMhasFramePacket frame(1, original.begin(), original.end(), true);
+    tools::embedConfigurationIntoPreRoll(frame, config);
+    MHAS_CHECK(frame.payload() == au);
+
+    // The AudioPreRoll already carries a config now
+    MHAS_CHECK_THROWS(tools::embedConfigurationIntoPreRoll(au, config), std::exception);
+  }
+}
+
+int main() {
+  runTest("CopyBits", testCopyBits);
+  runTest("InsertAsiInConfig", testInsertAsiInConfig);
+  runTest("EmbedConfigurationIntoPreRoll", testEmbedConfigurationIntoPreRoll);
+  return testResult();
+}
@@ -0,0 +1,204 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasasipacket.h"
+#include "mmtmhasparserlib/mhasinfowrapper.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Returns a stream of a config with the given profile level indication, an optional ASI and frames
+static ilo::ByteBuffer makeInfoStream(uint8_t profileLevelIndication, const ilo::ByteBuffer& asi,
+                                      uint32_t seed) {
+  std::mt19937 random(seed);
+  ilo::ByteBuffer config = makeConfig();
+  config[0] = profileLevelIndication;
+
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+  if (!asi.empty()) {
+    stream.add(CMhasAsiPacket(1, asi.begin(), asi.end()));
+  }
+  for (uint32_t i = 0; i < 4; ++i) {
+    const ilo::ByteBuffer payload = makeFramePayload(random, 200, i == 0);
+    stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  }
+  return stream.data();
+}
+
+// The version and snapshot only change if the info changes, repeated packets keep both
+static void testVersioning() {
+  const ilo::ByteBuffer asi = {0x05u, 0x14u};
+  CMhasInfoWrapper wrapper;
+  std::vector<std::shared_ptr<const CMhasInfoWrapper::SMhasBufferInfo>> published;
+  wrapper.changeCallback(
+      [&published](const std::shared_ptr<const CMhasInfoWrapper::SMhasBufferInfo>& info) {
+        published.push_back(info);
+      });
+
+  MHAS_CHECK(wrapper.version() == 0);
+  MHAS_CHECK(!wrapper.mhasInfoSnapshot());
+  MHAS_CHECK(!wrapper.isMhasInfoAvailable());
+  MHAS_CHECK_THROWS(wrapper.getMhasInfo(), std::exception);
+
+  wrapper.feed(makeInfoStream(0x0Du, ilo::ByteBuffer(), 61));
+  MHAS_CHECK(wrapper.isMhasInfoAvailable());
+  MHAS_CHECK(wrapper.version() == 1);
+  const auto first = wrapper.mhasInfoSnapshot();
+  MHAS_CHECK(first && first->version == 1);
+  MHAS_CHECK(published.size() == 1 && published.back() == first);
+
+  // The same config again
+  wrapper.feed(makeInfoStream(0x0Du, ilo::ByteBuffer(), 62));
+  MHAS_CHECK(wrapper.version() == 1);
+  MHAS_CHECK(wrapper.mhasInfoSnapshot() == first);
+
+  // A new ASI, repeated afterwards
+  wrapper.feed(makeInfoStream(0x0Du, asi, 63));
+  MHAS_CHECK(wrapper.version() == 2);
+  wrapper.feed(makeInfoStream(0x0Du, asi, 64));
+  MHAS_CHECK(wrapper.version() == 2);
+
+  // A new config
+  wrapper.feed(makeInfoStream(0x0Cu, asi, 65));
+  MHAS_CHECK(wrapper.version() == 3);
+  const auto third = wrapper.mhasInfoSnapshot();
+  MHAS_CHECK(third && third->version == 3 && !third->wasResynced);
+  MHAS_CHECK(wrapper.getMhasInfo().version == 3);
+
+  MHAS_CHECK(published.size() == 3 && published.back() == third);
+  MHAS_CHECK(first->version == 1);
+}
+
+// Another thread polling the version always gets a snapshot at least as new as the version
+static void testConcurrentPolling() {
+  const ilo::ByteBuffer asi = {0x05u, 0x14u};
+  const std::vector<ilo::ByteBuffer> streams = {makeInfoStream(0x0Du, ilo::ByteBuffer(), 66),
+                                                makeInfoStream(0x0Cu, asi, 67)};
+  const uint64_t numFeeds = 200;
+  CMhasInfoWrapper wrapper;
+  std::atomic<bool> isDone(false);
+  bool isConsistent = true;
+
+  std::thread poller([&wrapper, &isDone, &isConsistent]() {
+    uint64_t lastVersion = 0;
+    while (!isDone) {
+      const uint64_t version = wrapper.version();
+      const auto snapshot = wrapper.mhasInfoSnapshot();
+      if (version < lastVersion || (version > 0 && (!snapshot || snapshot->version < version))) {
+        isConsistent = false;
+      }
+      lastVersion = version;
+    }
+  });
+
+  for (uint64_t i = 0; i < numFeeds; ++i) {
+    wrapper.feed(streams[i % 2]);
+  }
+  isDone = true;
+  poller.join();
+
+  MHAS_CHECK(isConsistent);
+  MHAS_CHECK(wrapper.version() == numFeeds);
+  MHAS_CHECK(wrapper.mhasInfoSnapshot()->version == numFeeds);
+}
+
+int main() {
+  runTest("Versioning", testVersioning);
+  runTest("ConcurrentPolling", testConcurrentPolling);
+  return testResult();
+}
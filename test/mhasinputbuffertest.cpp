@@ -0,0 +1,277 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasinputbuffer.h"
+#include "mmtmhasparserlib/mhaspacketpool.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static ilo::ByteBuffer sequence(uint8_t first, std::size_t size) {
+  ilo::ByteBuffer bytes(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(first + i);
+  }
+  return bytes;
+}
+
+static ilo::ByteBuffer peekAll(const CMhasInputBuffer& buffer) {
+  ilo::ByteBuffer bytes(buffer.size());
+  MHAS_CHECK(buffer.peek(0, bytes.data(), bytes.size()) == bytes.size());
+  return bytes;
+}
+
+// Appending after consuming reuses the freed space at the beginning of the storage
+static void testWrapAround() {
+  CMhasInputBuffer buffer(16);
+  const ilo::ByteBuffer first = sequence(0, 10);
+  const ilo::ByteBuffer second = sequence(10, 10);
+
+  buffer.append(first.data(), first.size());
+  buffer.consume(8);
+  buffer.append(second.data(), second.size());
+
+  MHAS_CHECK(buffer.capacity() == 16);
+  MHAS_CHECK(buffer.size() == 12);
+  MHAS_CHECK(buffer.contiguousSize() == 8);
+  MHAS_CHECK(peekAll(buffer) == sequence(8, 12));
+
+  buffer.linearize(12);
+  MHAS_CHECK(buffer.capacity() == 16);
+  MHAS_CHECK(buffer.contiguousSize() == 12);
+  MHAS_CHECK(std::equal(buffer.data(), buffer.data() + 12, sequence(8, 12).begin()));
+}
+
+static void testGrowth() {
+  CMhasInputBuffer buffer(8);
+  const ilo::ByteBuffer bytes = sequence(0, 30);
+
+  buffer.append(bytes.data(), 6);
+  buffer.consume(4);
+  buffer.append(bytes.data() + 6, 24);
+
+  MHAS_CHECK(buffer.capacity() >= 26);
+  MHAS_CHECK(peekAll(buffer) == sequence(4, 26));
+
+  buffer.clear();
+  MHAS_CHECK(buffer.empty());
+  MHAS_CHECK(buffer.capacity() >= 26);
+}
+
+static void testPeekRange() {
+  CMhasInputBuffer buffer(8);
+  const ilo::ByteBuffer bytes = sequence(0, 6);
+  buffer.append(bytes.data(), bytes.size());
+
+  uint8_t dest[8] = {};
+  MHAS_CHECK(buffer.peek(4, dest, 8) == 2);
+  MHAS_CHECK(dest[0] == 4 && dest[1] == 5);
+  MHAS_CHECK(buffer.peek(6, dest, 8) == 0);
+  MHAS_CHECK(buffer.size() == 6);
+}
+
+// Packets spanning the end of the circular storage are parsed like contiguous ones
+static void testParserWithSmallBuffer() {
+  const CTestStream stream = makeTestStream(40, 1, 400);
+  std::mt19937 random(2);
+
+  CMhasParser parser(512);
+  CPacketDeque packets;
+  std::size_t offset = 0;
+  while (offset < stream.data().size()) {
+    const std::size_t size =
+        std::min<std::size_t>(1 + random() % 300, stream.data().size() - offset);
+    parser.feed(stream.data().data() + offset, size);
+    offset += size;
+
+    parser.parsePackets();
+    for (auto& packet : parser.allAvailablePackets()) {
+      packets.push_back(std::move(packet));
+    }
+  }
+
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(parser.numBytesPending() == 0);
+}
+
+// Bytes of a shared storage are not overwritten while a handle to it is held
+static void testSharedStorage() {
+  CMhasInputBuffer buffer(64);
+  const ilo::ByteBuffer first = sequence(0, 32);
+  const ilo::ByteBuffer second = sequence(100, 60);
+
+  buffer.append(first.data(), first.size());
+  std::shared_ptr<const uint8_t> storage = buffer.storage();
+  MHAS_CHECK(storage == buffer.storage());
+  const uint8_t* data = buffer.data();
+
+  buffer.consume(first.size());
+  buffer.append(second.data(), second.size());
+  MHAS_CHECK(std::equal(first.begin(), first.end(), data));
+  MHAS_CHECK(peekAll(buffer) == second);
+  MHAS_CHECK(buffer.storage() != storage);
+}
+
+// Retired storage is reused once all packets referencing it are released on another thread
+static void testSharedStorageReleasedOnOtherThread() {
+  const std::size_t capacity = 4096;
+  const CTestStream stream = makeTestStream(400, 6, 1000);
+  auto memoryResource = std::make_shared<CCountingMemoryResource>();
+
+  CMhasParser parser(capacity, memoryResource);
+  parser.payloadStorage(EPayloadStorage::Shared);
+  std::size_t numPackets = 0;
+  bool isMatching = true;
+  for (std::size_t offset = 0; offset < stream.data().size(); offset += 700) {
+    parser.feed(stream.data().data() + offset,
+                std::min<std::size_t>(700, stream.data().size() - offset));
+    parser.parsePackets();
+
+    CPacketDeque packets = parser.allAvailablePackets();
+    isMatching = isMatching && matchesPackets(packets, stream, numPackets);
+    numPackets += packets.size();
+    std::thread releaseThread([&packets]() { packets.clear(); });
+    releaseThread.join();
+  }
+
+  MHAS_CHECK(isMatching);
+  MHAS_CHECK(numPackets == stream.packets().size());
+  // The initial storage plus the spares kept for reuse, independent of the stream length
+  MHAS_CHECK(memoryResource->numAllocations(capacity) <= 4);
+}
+
+// The input buffer, including grown storage, and the pooled packets allocate from the given
+// resource and return all memory to it once destroyed
+static void testMemoryResource() {
+  const std::size_t capacity = 1024;
+  const CTestStream stream = makeTestStream(40, 7);
+  auto memoryResource = std::make_shared<CCountingMemoryResource>();
+
+  std::unique_ptr<CMhasParser> parser(new CMhasParser(capacity, memoryResource));
+  parser->packetPool(CMhasPacketPool::s_create(8, memoryResource));
+  parser->payloadStorage(EPayloadStorage::Shared);
+  MHAS_CHECK(memoryResource->numAllocations(capacity) == 1);
+
+  // Feeding the whole stream at once grows the input buffer
+  parser->feed(stream.data());
+  MHAS_CHECK(memoryResource->allocatedBytes() >= stream.data().size());
+  parser->parsePackets();
+
+  CPacketDeque packets = parser->allAvailablePackets();
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  MHAS_CHECK(memoryResource->numAllocations() > packets.size());
+
+  // Shared payloads keep the storage alive after the parser is destroyed
+  parser.reset();
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(memoryResource->allocatedBytes() > 0);
+
+  packets.clear();
+  MHAS_CHECK(memoryResource->allocatedBytes() == 0);
+}
+
+int main() {
+  runTest("WrapAround", testWrapAround);
+  runTest("Growth", testGrowth);
+  runTest("PeekRange", testPeekRange);
+  runTest("ParserWithSmallBuffer", testParserWithSmallBuffer);
+  runTest("SharedStorage", testSharedStorage);
+  runTest("SharedStorageReleasedOnOtherThread", testSharedStorageReleasedOnOtherThread);
+  runTest("MemoryResource", testMemoryResource);
+  return testResult();
+}
@@ -0,0 +1,181 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhaspacketpool.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static CPacketDeque parseStream(const CTestStream& stream,
+                                const std::shared_ptr<CMhasPacketPool>& pool) {
+  CMhasParser parser;
+  parser.packetPool(pool);
+  parser.feed(stream.data());
+  parser.parsePackets();
+  return parser.allAvailablePackets();
+}
+
+// Released packets are reused for the next packets of the same type, without stale payload bytes
+static void testPacketReuse() {
+  const CTestStream stream = makeTestStream(30, 31);
+  const CTestStream otherStream = makeTestStream(30, 32);
+  auto pool = CMhasPacketPool::s_create();
+
+  CPacketDeque packets = parseStream(stream, pool);
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  CMhasPacketPool::SStatistics statistics = pool->statistics();
+  MHAS_CHECK(statistics.packetsInUse == packets.size());
+  MHAS_CHECK(statistics.packetAllocations == packets.size());
+  MHAS_CHECK(statistics.packetReuses == 0);
+
+  const uint64_t numPackets = packets.size();
+  packets.clear();
+  statistics = pool->statistics();
+  MHAS_CHECK(statistics.packetsInUse == 0);
+  MHAS_CHECK(statistics.packetsInUseHighWater == numPackets);
+  MHAS_CHECK(statistics.pooledPackets == numPackets);
+  MHAS_CHECK(statistics.pooledPayloadBuffers > 0);
+
+  packets = parseStream(otherStream, pool);
+  MHAS_CHECK(matchesPackets(packets, otherStream));
+  MHAS_CHECK(packets.size() == otherStream.packets().size());
+  statistics = pool->statistics();
+  MHAS_CHECK(statistics.packetAllocations == numPackets);
+  MHAS_CHECK(statistics.packetReuses == packets.size());
+}
+
+// At most the configured number of packets is kept per type and trim frees the kept ones
+static void testPooledLimitAndTrim() {
+  const CTestStream stream = makeTestStream(30, 33);
+  auto pool = CMhasPacketPool::s_create(4);
+
+  parseStream(stream, pool);
+  CMhasPacketPool::SStatistics statistics = pool->statistics();
+  MHAS_CHECK(statistics.packetsInUse == 0);
+  // 4 frame, 4 sync and 4 config packets
+  MHAS_CHECK(statistics.pooledPackets == 3 * 4);
+  MHAS_CHECK(statistics.pooledPayloadBuffers <= 2 * 4);
+
+  pool->trim(1);
+  MHAS_CHECK(pool->statistics().pooledPackets == 3);
+
+  pool->trim();
+  statistics = pool->statistics();
+  MHAS_CHECK(statistics.pooledPackets == 0);
+  MHAS_CHECK(statistics.pooledPayloadBuffers == 0);
+  MHAS_CHECK(statistics.pooledPayloadCapacity == 0);
+  MHAS_CHECK(statistics.packetsInUseHighWater == 0);
+}
+
+// Packets keep their pool alive and may be released on another thread after the pool handle is
+// gone, which returns all memory to the resource of the pool
+static void testPacketsOutlivePool() {
+  const CTestStream stream = makeTestStream(20, 34);
+  auto resource = std::make_shared<CCountingMemoryResource>();
+
+  CPacketDeque packets = parseStream(stream, CMhasPacketPool::s_create(8, resource));
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(resource->allocatedBytes() > 0);
+
+  std::thread releaser([&packets]() { packets.clear(); });
+  releaser.join();
+  MHAS_CHECK(resource->allocatedBytes() == 0);
+}
+
+int main() {
+  runTest("PacketReuse", testPacketReuse);
+  runTest("PooledLimitAndTrim", testPooledLimitAndTrim);
+  runTest("PacketsOutlivePool", testPacketsOutlivePool);
+  return testResult();
+}
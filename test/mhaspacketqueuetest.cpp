@@ -0,0 +1,231 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhaspacketqueue.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+static CPacketDeque parsePackets(const CTestStream& stream) {
+  CPacketDeque packets;
+  auto begin = stream.data().begin();
+  while (begin != stream.data().end()) {
+    packets.push_back(CMhasPacket::s_parseNextPacket(begin, stream.data().end(), true));
+  }
+  return packets;
+}
+
+// Packets are popped in push order and a full queue rejects packets without taking them
+static void testPushPop() {
+  const CTestStream stream = makeTestStream(9, 41);
+  CPacketDeque packets = parsePackets(stream);
+  MHAS_CHECK(packets.size() == 13);
+
+  CMhasPacketQueue queue(5);
+  MHAS_CHECK(queue.capacity() == 8);
+  MHAS_CHECK(queue.empty());
+  MHAS_CHECK(!queue.tryPop());
+
+  for (std::size_t i = 0; i < 8; ++i) {
+    MHAS_CHECK(queue.tryPush(packets[i]));
+    MHAS_CHECK(!packets[i]);
+  }
+  MHAS_CHECK(queue.size() == 8);
+  MHAS_CHECK(!queue.tryPush(packets[8]));
+  MHAS_CHECK(packets[8]);
+
+  CPacketDeque popped;
+  while (auto packet = queue.tryPop()) {
+    popped.push_back(std::move(packet));
+  }
+  popped.push_back(std::move(packets[8]));
+  for (std::size_t i = 9; i < packets.size(); ++i) {
+    popped.push_back(std::move(packets[i]));
+  }
+  MHAS_CHECK(queue.empty());
+  MHAS_CHECK(matchesPackets(popped, stream));
+}
+
+// A consumer thread receives all packets parsed by a producer thread in stream order
+static void testProducerConsumer() {
+  const CTestStream stream = makeTestStream(500, 42, 800);
+  auto queue = std::make_shared<CMhasPacketQueue>(4);
+
+  CPacketDeque packets;
+  std::thread consumer([&queue, &packets, &stream]() {
+    while (packets.size() < stream.packets().size()) {
+      if (auto packet = queue->tryPop()) {
+        packets.push_back(std::move(packet));
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::mt19937 random(43);
+  CMhasParser parser;
+  parser.outputQueue(queue);
+  std::size_t offset = 0;
+  while (offset < stream.data().size()) {
+    const std::size_t size =
+        std::min<std::size_t>(1 + random() % 2000, stream.data().size() - offset);
+    parser.feed(stream.data().data() + offset, size);
+    offset += size;
+    parser.parsePackets();
+    while (parser.isOutputBlocked()) {
+      std::this_thread::yield();
+      parser.parsePackets();
+    }
+  }
+  consumer.join();
+
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  MHAS_CHECK(parser.numBytesPending() == 0);
+}
+
+// Regression test: a lent buffer fed behind a blocked output queue is kept pending instead of
+// being parsed out of order, and no packet is lost when the queue is drained
+static void testBlockedQueueWithLentBuffer() {
+  CTestStream stream;
+  for (uint8_t i = 0; i < 4; ++i) {
+    const ilo::ByteBuffer payload(100, i);
+    stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  }
+  const std::size_t split = stream.data().size() * 7 / 8;
+  const std::size_t lentSize = stream.data().size() - split;
+
+  auto queue = std::make_shared<CMhasPacketQueue>(1);
+  CMhasParser parser;
+  parser.sync();
+  parser.outputQueue(queue);
+  parser.feed(stream.data().data(), split);
+
+  uint32_t numReleased = 0;
+  uint8_t* chunk = new uint8_t[lentSize];
+  std::copy_n(stream.data().data() + split, lentSize, chunk);
+  parser.feed(std::shared_ptr<const uint8_t>(chunk,
+                                             [&numReleased](const uint8_t* pointer) {
+                                               delete[] pointer;
+                                               ++numReleased;
+                                             }),
+              lentSize);
+  parser.parsePackets();
+  MHAS_CHECK(parser.isOutputBlocked());
+  MHAS_CHECK(numReleased == 1);
+
+  CPacketDeque packets;
+  for (uint32_t i = 0; i < 10; ++i) {
+    while (auto packet = queue->tryPop()) {
+      packets.push_back(std::move(packet));
+    }
+    parser.parsePackets();
+  }
+  while (auto packet = queue->tryPop()) {
+    packets.push_back(std::move(packet));
+  }
+
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  MHAS_CHECK(!parser.isOutputBlocked());
+  MHAS_CHECK(parser.numBytesPending() == 0);
+}
+
+int main() {
+  runTest("PushPop", testPushPop);
+  runTest("ProducerConsumer", testProducerConsumer);
+  runTest("BlockedQueueWithLentBuffer", testBlockedQueueWithLentBuffer);
+  return testResult();
+}
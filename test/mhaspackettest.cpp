@@ -0,0 +1,500 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// External includes
+#include "ilo/bitbuffer.h"
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasasipacket.h"
+#include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhaspacket.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Writes an escaped value as defined in ISO/IEC 23003-3 without using the library implementation
+static void writeEscapedReference(ilo::CBitBuffer& bitBuffer, uint64_t value, uint32_t first,
+                                  uint32_t second, uint32_t third) {
+  const uint64_t firstEscape = (uint64_t{1} << first) - 1;
+  const uint64_t secondEscape = (uint64_t{1} << second) - 1;
+  if (value < firstEscape) {
+    bitBuffer.write(value, first);
+    return;
+  }
+  bitBuffer.write(firstEscape, first);
+  value -= firstEscape;
+  if (value < secondEscape) {
+    bitBuffer.write(value, second);
+    return;
+  }
+  bitBuffer.write(secondEscape, second);
+  bitBuffer.write(value - secondEscape, third);
+}
+
+static ilo::ByteBuffer makeHeader(uint64_t packetType, uint64_t packetLabel,
+                                  uint64_t payloadLength) {
+  ilo::ByteBuffer header(16, 0);
+  ilo::CBitBuffer bitBuffer(header, static_cast<uint32_t>(header.size() * 8));
+  writeEscapedReference(bitBuffer, packetType, 3, 8, 8);
+  writeEscapedReference(bitBuffer, packetLabel, 2, 8, 32);
+  writeEscapedReference(bitBuffer, payloadLength, 11, 24, 24);
+  header.resize(bitBuffer.tell() / 8);
+  return header;
+}
+
+// Headers around all escape boundaries decode like the reference, both from two byte headers via
+// the fast path and from escaped ones
+static void testDecodeHeader() {
+  const std::vector<uint64_t> packetTypes = {0, 1, 6, 7, 8, 261, 262, 517};
+  const std::vector<uint64_t> packetLabels = {0, 2, 3, 4, 257, 258, 0xFFFFFFFFu};
+  const std::vector<uint64_t> payloadLengths = {0, 1, 2046, 2047, 2048, 16779261, 16779262,
+                                                33556477};
+
+  for (uint64_t packetType : packetTypes) {
+    for (uint64_t packetLabel : packetLabels) {
+      for (uint64_t payloadLength : payloadLengths) {
+        const ilo::ByteBuffer bytes = makeHeader(packetType, packetLabel, payloadLength);
+        const uint8_t* begin = bytes.data();
+
+        SMhasPacketHeader header;
+        MHAS_CHECK(CMhasPacket::s_decodeHeader(begin, begin + bytes.size(), header));
+        MHAS_CHECK(header.packetType == packetType);
+        MHAS_CHECK(header.packetLabel == packetLabel);
+        MHAS_CHECK(header.payloadLength == payloadLength);
+        MHAS_CHECK(header.headerLength == bytes.size());
+        MHAS_CHECK(header.packetSize() == bytes.size() + payloadLength);
+
+        // A truncated header is never decoded
+        MHAS_CHECK(!CMhasPacket::s_decodeHeader(begin, begin + bytes.size() - 1, header));
+      }
+    }
+  }
+}
+
+// The decoded header matches the header written by a packet
+static void testDecodeWrittenHeader() {
+  std::mt19937 random(7);
+  const ilo::ByteBuffer payload = makeFramePayload(random, 3000, false);
+  for (uint64_t label : {1u, 3u, 1000u}) {
+    ilo::ByteBuffer bytes;
+    CMhasFramePacket(label, payload.begin(), payload.end(), true).writePacket(bytes);
+
+    SMhasPacketHeader header;
+    MHAS_CHECK(CMhasPacket::s_decodeHeader(bytes.data(), bytes.data() + bytes.size(), header));
+    MHAS_CHECK(header.packetType ==
+               static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME));
+    MHAS_CHECK(header.packetLabel == label);
+    MHAS_CHECK(header.payloadLength == payload.size());
+    MHAS_CHECK(header.packetSize() == bytes.size());
+  }
+}
+
+// Valid, truncated and invalid packets are reported by status and only complete ones are consumed
+static void testParseWithStatus() {
+  std::mt19937 random(20);
+  ilo::ByteBuffer payload = makeFramePayload(random, 100, false);
+  CTestStream stream;
+  stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  // Reserved combination of usacIndependencyFlag and usacExtElementPresent flags
+  payload[0] = 0xE0u;
+  stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), false));
+  const ilo::ByteBuffer& bytes = stream.data();
+
+  const uint8_t* begin = bytes.data();
+  const uint8_t* end = bytes.data() + bytes.size();
+  SMhasParseResult result = CMhasPacket::s_parseNextPacketWithStatus(begin, end - 1, true);
+  MHAS_CHECK(result.ok());
+  MHAS_CHECK(result.packet && result.packet->payload() == stream.packets()[0].payload);
+  MHAS_CHECK(begin == bytes.data() + result.header.packetSize());
+
+  const uint8_t* const second = begin;
+  result = CMhasPacket::s_parseNextPacketWithStatus(begin, end - 1, true);
+  MHAS_CHECK(result.status == EParseStatus::NeedMoreData);
+  MHAS_CHECK(!result.packet);
+  MHAS_CHECK(begin == second);
+
+  result = CMhasPacket::s_parseNextPacketWithStatus(begin, end, true);
+  MHAS_CHECK(result.status == EParseStatus::InvalidPayload);
+  MHAS_CHECK(!result.packet);
+  MHAS_CHECK(result.header.payloadLength == payload.size());
+  MHAS_CHECK(begin == end);
+
+  // Without AudioPreRoll, the flags are not validated
+  begin = second;
+  result = CMhasPacket::s_parseNextPacketWithStatus(begin, end, false);
+  MHAS_CHECK(result.ok());
+  MHAS_CHECK(begin == end);
+}
+
+// Creating a packet from a decoded header reports an invalid payload like parsing does
+static void testCreatePacketWithStatus() {
+  const ilo::ByteBuffer config = makeConfig();
+  SMhasPacketHeader header;
+  header.packetType = static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DACFG);
+  header.packetLabel = 1;
+  header.payloadLength = config.size();
+  header.headerLength = 2;
+
+  SMhasParseResult result = CMhasPacket::s_createPacketWithStatus(header, config.data(), false);
+  MHAS_CHECK(result.ok());
+  MHAS_CHECK(result.packet && result.packet->payload() == config);
+
+  const ilo::ByteBuffer frame = {0xE0u, 0x00u, 0x00u};
+  header.packetType = static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME);
+  header.payloadLength = frame.size();
+  result = CMhasPacket::s_createPacketWithStatus(header, frame.data(), true);
+  MHAS_CHECK(result.status == EParseStatus::InvalidPayload);
+  MHAS_CHECK(!result);
+}
+
+// mae_AudioSceneInfo() of a stream which is not the main stream, with metaDataElementIDOffset 5
+// and metaDataElementIDmaxAvail 10
+static const ilo::ByteBuffer NON_MAIN_STREAM_ASI = {0x05u, 0x14u};
+
+// Parses the given stream at once with the given payload decoding
+static CPacketDeque parseStream(const ilo::ByteBuffer& bytes, EPayloadDecoding decoding) {
+  CMhasParser parser;
+  parser.payloadDecoding(decoding);
+  parser.feed(bytes);
+  parser.parsePackets();
+  return parser.allAvailablePackets();
+}
+
+// With lazy decoding, ASI packets and repeated config packets are decoded on first access. The
+// parser only decodes a config if it differs from the previous one.
+static void testLazyDecoding() {
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+  stream.add(CMhasAsiPacket(1, NON_MAIN_STREAM_ASI.begin(), NON_MAIN_STREAM_ASI.end()));
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+
+  for (auto decoding : {EPayloadDecoding::Eager, EPayloadDecoding::Lazy}) {
+    const CPacketDeque packets = parseStream(stream.data(), decoding);
+    MHAS_CHECK(matchesPackets(packets, stream));
+    MHAS_CHECK(packets.size() == 4);
+    if (packets.size() != 4) {
+      continue;
+    }
+
+    const auto& asiPacket = dynamic_cast<const CMhasAsiPacket&>(*packets[2]);
+    const auto& configPacket = dynamic_cast<const CMhasConfigPacket&>(*packets[3]);
+    MHAS_CHECK(dynamic_cast<const CMhasConfigPacket&>(*packets[1]).isDecoded());
+    MHAS_CHECK(asiPacket.isDecoded() == (decoding == EPayloadDecoding::Eager));
+    MHAS_CHECK(configPacket.isDecoded() == (decoding == EPayloadDecoding::Eager));
+
+    MHAS_CHECK(asiPacket.audioSceneInfo().metaDataElementIDOffset == 5);
+    MHAS_CHECK(asiPacket.audioSceneInfo().metaDataElementIDmaxAvail == 10);
+    MHAS_CHECK(asiPacket.isDecoded());
+    MHAS_CHECK(configPacket.mhasConfigInfo().outputSamplingFrequency == 48000);
+    MHAS_CHECK(configPacket.mhasConfigInfo().outputFramesize == 1024);
+    MHAS_CHECK(configPacket.isDecoded());
+  }
+}
+
+// A lazily decoded packet shared between threads is decoded once, all threads see the same result
+static void testLazyDecodingConcurrent() {
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+  stream.add(CMhasAsiPacket(1, NON_MAIN_STREAM_ASI.begin(), NON_MAIN_STREAM_ASI.end()));
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+
+  for (uint32_t iteration = 0; iteration < 20; ++iteration) {
+    const CPacketDeque packets = parseStream(stream.data(), EPayloadDecoding::Lazy);
+    MHAS_CHECK(packets.size() == 4);
+    if (packets.size() != 4) {
+      return;
+    }
+    const auto& asiPacket = dynamic_cast<const CMhasAsiPacket&>(*packets[2]);
+    const auto& configPacket = dynamic_cast<const CMhasConfigPacket&>(*packets[3]);
+
+    const std::size_t numThreads = 4;
+    std::vector<const CMhasConfigPacket::SConfig*> configs(numThreads);
+    std::vector<const CMhasAsiPacket::SAudioSceneInfo*> sceneInfos(numThreads);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < numThreads; ++i) {
+      threads.emplace_back([&, i]() {
+        configs[i] = &configPacket.mhasConfigInfo();
+        sceneInfos[i] = &asiPacket.audioSceneInfo();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (std::size_t i = 0; i < numThreads; ++i) {
+      MHAS_CHECK(configs[i] == &configPacket.mhasConfigInfo());
+      MHAS_CHECK(sceneInfos[i] == &asiPacket.audioSceneInfo());
+    }
+  }
+}
+
+// With lazy decoding, an invalid payload is reported by the accessor instead of the parser
+static void testLazyDecodingError() {
+  // isMainStream is set, but the payload ends before the groups
+  const ilo::ByteBuffer invalidAsi = {0x80u};
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  SMhasPacketHeader header;
+  header.packetType = static_cast<uint32_t>(EMhasPacketType::PACTYP_AUDIOSCENEINFO);
+  header.packetLabel = 1;
+  header.payloadLength = invalidAsi.size();
+  stream.add(CMhasPacket(header, invalidAsi.data()));
+
+  const CPacketDeque packets = parseStream(stream.data(), EPayloadDecoding::Lazy);
+  MHAS_CHECK(packets.size() == 2);
+  if (packets.size() == 2) {
+    const auto& asiPacket = dynamic_cast<const CMhasAsiPacket&>(*packets[1]);
+    MHAS_CHECK_THROWS(asiPacket.audioSceneInfo(), std::exception);
+    MHAS_CHECK(!asiPacket.isDecoded());
+  }
+
+  MHAS_CHECK_THROWS(parseStream(stream.data(), EPayloadDecoding::Eager), std::exception);
+}
+
+// The records of a scan match the packets of the stream and the scan stops after every config
+static void testScanPackets() {
+  const CTestStream stream = makeTestStream(20, 51);
+  const uint8_t* const data = stream.data().data();
+  const uint8_t* const end = data + stream.data().size() - 1;
+
+  for (bool audioPreRollPresent : {true, false}) {
+    const uint8_t* begin = data;
+    std::size_t numPackets = 0;
+    uint32_t numFrames = 0;
+    SMhasPacketRecord records[4];
+    while (std::size_t numRecords = CMhasPacket::s_scanPackets(begin, end, records, 4,
+                                                               audioPreRollPresent)) {
+      const uint8_t* position = begin;
+      for (std::size_t i = numRecords; i > 0; --i) {
+        position -= records[i - 1].packetSize();
+      }
+      for (std::size_t i = 0; i < numRecords; ++i) {
+        const SMhasPacketRecord& record = records[i];
+        const STestPacket& expected = stream.packets()[numPackets++];
+        MHAS_CHECK(record.packetType == expected.packetType);
+        MHAS_CHECK(record.packetLabel == expected.packetLabel);
+        MHAS_CHECK(record.payloadLength == expected.payload.size());
+        MHAS_CHECK(std::equal(expected.payload.begin(), expected.payload.end(),
+                              position + record.offset + record.headerLength));
+
+        const bool isConfig =
+            record.packetType == static_cast<uint16_t>(EMhasPacketType::PACTYP_MPEGH3DACFG);
+        MHAS_CHECK(!isConfig || i + 1 == numRecords);
+        if (record.packetType == static_cast<uint16_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+          const bool isIPF = numFrames++ % 8 == 0;
+          MHAS_CHECK(record.isIF() == isIPF);
+          MHAS_CHECK(record.isIPF() == (isIPF && audioPreRollPresent));
+        }
+      }
+    }
+
+    // The truncated last frame with its two byte header is not indexed
+    MHAS_CHECK(numPackets + 1 == stream.packets().size());
+    MHAS_CHECK(begin + stream.packets().back().payload.size() + 2 == data + stream.data().size());
+  }
+}
+
+// Snapshots keep the decoded structures of a packet alive and are not affected by a new payload
+static void testSnapshots() {
+  ilo::ByteBuffer config = makeConfig();
+  std::unique_ptr<CMhasConfigPacket> configPacket(
+      new CMhasConfigPacket(1, config.begin(), config.end()));
+  const std::shared_ptr<const CMhasConfigPacket::SConfig> configSnapshot =
+      configPacket->mhasConfigSnapshot();
+  MHAS_CHECK(configSnapshot.get() == &configPacket->mhasConfigInfo());
+  MHAS_CHECK(configSnapshot->profileLevelIndication == 0x0Du);
+
+  // LC profile level 2
+  config[0] = 0x0Cu;
+  configPacket->payload(config.begin(), config.end());
+  MHAS_CHECK(configPacket->mhasConfigInfo().profileLevelIndication == 0x0Cu);
+  MHAS_CHECK(configPacket->mhasConfigSnapshot() != configSnapshot);
+
+  std::unique_ptr<CMhasAsiPacket> asiPacket(
+      new CMhasAsiPacket(1, NON_MAIN_STREAM_ASI.begin(), NON_MAIN_STREAM_ASI.end()));
+  const std::shared_ptr<const CMhasAsiPacket::SAudioSceneInfo> asiSnapshot =
+      asiPacket->audioSceneInfoSnapshot();
+  MHAS_CHECK(asiSnapshot.get() == &asiPacket->audioSceneInfo());
+
+  // metaDataElementIDOffset 6 instead of 5
+  const ilo::ByteBuffer asi = {0x06u, 0x14u};
+  asiPacket->payload(asi.begin(), asi.end());
+  MHAS_CHECK(asiPacket->audioSceneInfo().metaDataElementIDOffset == 6);
+
+  configPacket.reset();
+  asiPacket.reset();
+  MHAS_CHECK(configSnapshot->profileLevelIndication == 0x0Du);
+  MHAS_CHECK(configSnapshot->samplingFrequency == 48000);
+  MHAS_CHECK(!asiSnapshot->isMainStream);
+  MHAS_CHECK(asiSnapshot->metaDataElementIDOffset == 5);
+}
+
+// Returns signals of a channel group with the IDs 0 and 1 and an object group with the ID 2
+static CMhasConfigPacket::SSignals3d makeSignals() {
+  using SSignalGroup = CMhasConfigPacket::SSignals3d::SSignalGroup;
+  CMhasConfigPacket::SSignals3d signals;
+  const std::vector<std::vector<uint8_t>> ids = {{0, 1}, {2}};
+  for (std::size_t index = 0; index < ids.size(); ++index) {
+    auto group = std::make_shared<SSignalGroup>();
+    group->idx = static_cast<uint8_t>(index);
+    group->signalGroupType = index == 0 ? SSignalGroup::ESignalGroupType::CHANNELS
+                                        : SSignalGroup::ESignalGroupType::OBJECT;
+    group->metaDataElementIds = ids[index];
+    group->numSignals = static_cast<uint32_t>(ids[index].size());
+    for (std::size_t number = 0; number < ids[index].size(); ++number) {
+      auto& signal = signals.signalTable[ids[index][number]];
+      signal.signalGroupIndex = static_cast<uint8_t>(index);
+      signal.signalNumber = static_cast<uint8_t>(number);
+    }
+    signals.signalGroups.push_back(group);
+  }
+  return signals;
+}
+
+// Signals are looked up by metadata element ID, without and with the offset of an applied ASI
+static void testSignalLookup() {
+  CMhasConfigPacket::SConfig config;
+  config.signals3d = makeSignals();
+  const auto& signals = config.signals3d;
+  const auto originalGroup = signals.signalGroups[0];
+
+  MHAS_CHECK(signals.signal(1).isValid());
+  MHAS_CHECK(signals.signal(1).signalNumber == 1);
+  MHAS_CHECK(signals.signalGroup(signals.signal(1)) == originalGroup);
+  MHAS_CHECK(signals.signalGroup(signals.signal(2))->idx == 1);
+  MHAS_CHECK(!signals.signal(3).isValid());
+  MHAS_CHECK(!signals.signalGroup(signals.signal(3)));
+
+  // A main stream ASI does not shift the IDs
+  CMhasAsiPacket::SAudioSceneInfo mainStreamAsi;
+  mainStreamAsi.isMainStream = true;
+  config.applyAsi(mainStreamAsi);
+  MHAS_CHECK(signals.metaDataElementIdOffset() == 0);
+
+  // The IDs of a stream with metaDataElementIDOffset 5 start at 6
+  const CMhasAsiPacket asiPacket(1, NON_MAIN_STREAM_ASI.begin(), NON_MAIN_STREAM_ASI.end());
+  config.applyAsi(asiPacket.audioSceneInfo());
+  MHAS_CHECK(signals.metaDataElementIdOffset() == 6);
+  MHAS_CHECK(signals.signal(7).signalNumber == 1);
+  MHAS_CHECK(signals.signalGroup(signals.signal(7))->idx == 0);
+  MHAS_CHECK(signals.signalGroup(signals.signal(8))->idx == 1);
+  MHAS_CHECK(!signals.signal(1).isValid());
+  MHAS_CHECK(!signals.signal(9).isValid());
+  MHAS_CHECK(signals.signalGroups[0]->metaDataElementIds == std::vector<uint8_t>({6, 7}));
+  MHAS_CHECK(signals.signalGroups[1]->metaDataElementIds == std::vector<uint8_t>({8}));
+
+  // Shared groups are not modified and only the first ASI is applied
+  MHAS_CHECK(originalGroup->metaDataElementIds == std::vector<uint8_t>({0, 1}));
+  const ilo::ByteBuffer otherAsi = {0x06u, 0x14u};
+  config.applyAsi(CMhasAsiPacket(1, otherAsi.begin(), otherAsi.end()).audioSceneInfo());
+  MHAS_CHECK(signals.metaDataElementIdOffset() == 6);
+  MHAS_CHECK(signals.signalGroups[0]->metaDataElementIds == std::vector<uint8_t>({6, 7}));
+}
+
+int main() {
+  runTest("DecodeHeader", testDecodeHeader);
+  runTest("DecodeWrittenHeader", testDecodeWrittenHeader);
+  runTest("ParseWithStatus", testParseWithStatus);
+  runTest("CreatePacketWithStatus", testCreatePacketWithStatus);
+  runTest("LazyDecoding", testLazyDecoding);
+  runTest("LazyDecodingConcurrent", testLazyDecodingConcurrent);
+  runTest("LazyDecodingError", testLazyDecodingError);
+  runTest("ScanPackets", testScanPackets);
+  runTest("Snapshots", testSnapshots);
+  runTest("SignalLookup", testSignalLookup);
+  return testResult();
+}
@@ -0,0 +1,617 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// External includes
+#include "ilo/bitbuffer.h"
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhascrc16.h"
+#include "mmtmhasparserlib/mhascrc16packet.h"
+#include "mmtmhasparserlib/mhaspacketqueue.h"
+#include "mmtmhasparserlib/mhasparser.h"
+#include "mmtmhasparserlib/mhassyncpacket.h"
+#include "mmtmhasparserlib/mhasutilities.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Returns a copy of the given bytes whose deleter counts the released chunks
+static std::shared_ptr<const uint8_t> lendChunk(const uint8_t* data, std::size_t size,
+                                                uint32_t& numReleased) {
+  uint8_t* chunk = new uint8_t[size];
+  std::copy_n(data, size, chunk);
+  return std::shared_ptr<const uint8_t>(chunk, [&numReleased](const uint8_t* pointer) {
+    delete[] pointer;
+    ++numReleased;
+  });
+}
+
+static void appendPackets(CMhasParser& parser, CPacketDeque& packets) {
+  for (auto& packet : parser.allAvailablePackets()) {
+    packets.push_back(std::move(packet));
+  }
+}
+
+// The parser drops its reference to a lent buffer when parsePackets returns
+static void testLentBuffer() {
+  const CTestStream stream = makeTestStream(30, 3);
+  std::mt19937 random(4);
+
+  CMhasParser parser;
+  CPacketDeque packets;
+  uint32_t numLent = 0;
+  uint32_t numReleased = 0;
+  std::size_t offset = 0;
+  while (offset < stream.data().size()) {
+    const std::size_t size =
+        std::min<std::size_t>(1 + random() % 2000, stream.data().size() - offset);
+    parser.feed(lendChunk(stream.data().data() + offset, size, numReleased), size);
+    ++numLent;
+    offset += size;
+
+    parser.parsePackets();
+    MHAS_CHECK(numReleased == numLent);
+    appendPackets(parser, packets);
+  }
+
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+}
+
+// With shared payload storage, frames parsed from a lent buffer keep it alive
+static void testLentBufferSharedPayload() {
+  const CTestStream stream = makeTestStream(8, 5);
+
+  CMhasParser parser;
+  parser.payloadStorage(EPayloadStorage::Shared);
+  // Without sync, the lent buffer is copied to search for a sync position
+  parser.sync();
+  uint32_t numReleased = 0;
+  parser.feed(lendChunk(stream.data().data(), stream.data().size(), numReleased),
+              stream.data().size());
+  parser.parsePackets();
+
+  CPacketDeque packets = parser.allAvailablePackets();
+  MHAS_CHECK(matchesPackets(packets, stream));
+  MHAS_CHECK(packets.size() == stream.packets().size());
+  MHAS_CHECK(numReleased == 0);
+  for (const auto& packet : packets) {
+    if (packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+      MHAS_CHECK(packet->isPayloadShared());
+    }
+  }
+
+  packets.clear();
+  MHAS_CHECK(numReleased == 1);
+}
+
+// Regression test: with the default sync strategy, a sync packet is accepted on its own, even if
+// the stream ends right after it
+static void testSyncPacketAtEndOfStream() {
+  std::mt19937 random(9);
+  CTestStream stream;
+  stream.addGarbage(randomBytes(random, 1000));
+  stream.add(CMhasSyncPacket());
+
+  CMhasParser parser;
+  parser.feed(stream.data());
+  parser.parsePackets();
+
+  MHAS_CHECK(parser.isSynced());
+  MHAS_CHECK(parser.syncSource() == ESyncSource::SyncPacket);
+  MHAS_CHECK(matchesPackets(parser.allAvailablePackets(), stream));
+  MHAS_CHECK(parser.numBytesPending() == 0);
+}
+
+// A sync packet split between two feeds is found
+static void testSyncPacketSplitBetweenFeeds() {
+  std::mt19937 random(10);
+  const CTestStream stream = makeTestStream(3, 11);
+  const std::size_t garbageSize = 500;
+  ilo::ByteBuffer bytes = randomBytes(random, garbageSize);
+  bytes.insert(bytes.end(), stream.data().begin(), stream.data().end());
+
+  CMhasParser parser;
+  for (std::size_t split = garbageSize + 1; split < garbageSize + 3; ++split) {
+    parser.reset();
+    parser.feed(bytes.data(), split);
+    parser.parsePackets();
+    MHAS_CHECK(!parser.isSynced());
+
+    parser.feed(bytes.data() + split, bytes.size() - split);
+    parser.parsePackets();
+    MHAS_CHECK(parser.isSynced());
+    CPacketDeque packets = parser.allAvailablePackets();
+    MHAS_CHECK(packets.size() == stream.packets().size());
+    MHAS_CHECK(matchesPackets(packets, stream));
+  }
+}
+
+// Returns frames of the given label without sync packets, so only a header chain can be locked on
+static CTestStream makeFramesWithoutSync(uint32_t numFrames, uint32_t seed, uint64_t label) {
+  std::mt19937 random(seed);
+  CTestStream stream;
+  for (uint32_t i = 0; i < numFrames; ++i) {
+    const ilo::ByteBuffer payload = makeFramePayload(random, 3 + random() % 1500, false);
+    stream.add(CMhasFramePacket(label, payload.begin(), payload.end(), false));
+  }
+  return stream;
+}
+
+// Parses the given bytes fed in chunks of random size up to maxChunkSize
+static CPacketDeque parseInChunks(CMhasParser& parser, const ilo::ByteBuffer& bytes,
+                                  std::size_t maxChunkSize, uint32_t seed) {
+  std::mt19937 random(seed);
+  CPacketDeque packets;
+  std::size_t offset = 0;
+  while (offset < bytes.size()) {
+    const std::size_t size = std::min<std::size_t>(1 + random() % maxChunkSize,
+                                                   bytes.size() - offset);
+    parser.feed(bytes.data() + offset, size);
+    offset += size;
+    parser.parsePackets();
+    appendPackets(parser, packets);
+  }
+  return packets;
+}
+
+// Without sync packets, the parser locks on a chain of consistent headers when tuning in in the
+// middle of a packet. The result does not depend on how the input is split into feeds.
+static void testHeaderChainLock() {
+  const CTestStream stream = makeFramesWithoutSync(40, 12, 1);
+  const ilo::ByteBuffer bytes(stream.data().begin() + 700, stream.data().end());
+
+  for (std::size_t maxChunkSize : {std::size_t{1} << 20, std::size_t{64}, std::size_t{1}}) {
+    CMhasParser parser;
+    parser.syncStrategy(ESyncStrategy::HeaderChain);
+    const CPacketDeque packets = parseInChunks(parser, bytes, maxChunkSize, 13);
+
+    MHAS_CHECK(parser.isSynced());
+    MHAS_CHECK(parser.syncSource() == ESyncSource::HeaderChain);
+    MHAS_CHECK(packets.size() + 2 >= stream.packets().size());
+    MHAS_CHECK(packets.size() < stream.packets().size());
+    MHAS_CHECK(matchesPackets(packets, stream, stream.packets().size() - packets.size()));
+  }
+}
+
+// The default strategy never locks on a header chain
+static void testSyncPacketStrategyIgnoresHeaderChain() {
+  const CTestStream stream = makeFramesWithoutSync(10, 14, 1);
+
+  CMhasParser parser;
+  parser.feed(stream.data());
+  parser.parsePackets();
+  MHAS_CHECK(!parser.isSynced());
+  MHAS_CHECK(parser.allAvailablePackets().empty());
+}
+
+// Regression test: with the header chain strategy, a sync packet followed by a label change is
+// accepted, as it happens in multi-program streams
+static void testHeaderChainSyncPacketWithLabelChange() {
+  std::mt19937 random(15);
+  // Bytes of 0xFF decode to headers with an untypical payload length, which never chain
+  const ilo::ByteBuffer garbage(300, 0xFFu);
+  const ilo::ByteBuffer config = makeConfig();
+
+  CTestStream stream;
+  stream.addGarbage(garbage);
+  stream.add(CMhasSyncPacket());
+  ilo::ByteBuffer payload = makeFramePayload(random, 200, false);
+  stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  stream.add(CMhasConfigPacket(2, config.begin(), config.end()));
+  payload = makeFramePayload(random, 200, true);
+  stream.add(CMhasFramePacket(2, payload.begin(), payload.end(), true));
+
+  CMhasParser parser;
+  parser.syncStrategy(ESyncStrategy::HeaderChain);
+  parser.feed(stream.data());
+  parser.parsePackets();
+
+  MHAS_CHECK(parser.isSynced());
+  MHAS_CHECK(parser.syncSource() == ESyncSource::SyncPacket);
+  MHAS_CHECK(matchesPackets(parser.allAvailablePackets(), stream));
+}
+
+// Regression test: unsynchronized input is not kept for header chains which wait for bytes far
+// beyond the search position, and searching it again does not grow with the pending bytes
+static void testHeaderChainPendingBytesBounded() {
+  std::mt19937 random(16);
+  CMhasParser parser;
+  parser.syncStrategy(ESyncStrategy::HeaderChain);
+
+  std::size_t maxPending = 0;
+  for (uint32_t i = 0; i < 128; ++i) {
+    parser.feed(randomBytes(random, 16 * 1024));
+    parser.parsePackets();
+    maxPending = std::max<std::size_t>(maxPending, parser.numBytesPending());
+  }
+  MHAS_CHECK(!parser.isSynced());
+  MHAS_CHECK(maxPending <= 512 * 1024);
+
+  // A stream appended to the garbage is still found
+  const CTestStream stream = makeTestStream(4, 17);
+  parser.feed(stream.data());
+  parser.parsePackets();
+  MHAS_CHECK(parser.isSynced());
+  MHAS_CHECK(matchesPackets(parser.allAvailablePackets(), stream));
+}
+
+// Returns the indices stored in the second payload byte of the given frame packets
+static std::vector<uint8_t> frameIndices(const CPacketDeque& packets) {
+  std::vector<uint8_t> indices;
+  for (const auto& packet : packets) {
+    if (packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+      indices.push_back(packet->payload()[1]);
+    }
+  }
+  return indices;
+}
+
+// In resilient mode, frames with an invalid payload are dropped and counted, strict mode throws
+static void testResilientInvalidPayload() {
+  std::mt19937 random(18);
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+  for (uint8_t i = 0; i < 6; ++i) {
+    ilo::ByteBuffer payload = makeFramePayload(random, 100, i == 0);
+    payload[1] = i;
+    if (i == 3) {
+      // Reserved combination of usacIndependencyFlag and usacExtElementPresent flags
+      payload[0] = 0xE0u;
+    }
+    stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), false));
+  }
+
+  CMhasParser resilientParser;
+  resilientParser.errorHandling(EErrorHandling::Resilient);
+  resilientParser.feed(stream.data());
+  resilientParser.parsePackets();
+  MHAS_CHECK(frameIndices(resilientParser.allAvailablePackets()) ==
+             std::vector<uint8_t>({0, 1, 2, 4, 5}));
+  MHAS_CHECK(resilientParser.errorCounters().invalidPayloads == 1);
+  MHAS_CHECK(resilientParser.errorCounters().implausibleHeaders == 0);
+
+  CMhasParser strictParser;
+  strictParser.feed(stream.data());
+  MHAS_CHECK_THROWS(strictParser.parsePackets(), std::exception);
+}
+
+// Appends a frame header declaring payloadLength bytes, followed by the shorter given payload
+static void addCorruptedFrame(CTestStream& stream, uint64_t payloadLength,
+                              const ilo::ByteBuffer& payload) {
+  ilo::ByteBuffer bytes(16, 0);
+  ilo::CBitBuffer bitBuffer(bytes, static_cast<uint32_t>(bytes.size() * 8));
+  writeEscaped<3, 8, 8>(bitBuffer,
+                        static_cast<uint64_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME));
+  writeEscaped<2, 8, 32>(bitBuffer, 1);
+  writeEscaped<11, 24, 24>(bitBuffer, payloadLength);
+  bytes.resize(bitBuffer.tell() / 8);
+  bytes.insert(bytes.end(), payload.begin(), payload.end());
+  stream.addGarbage(bytes);
+}
+
+// Regression test: a frame whose payload length is corrupted to a large value does not stall
+// resilient parsing until that many bytes arrived. The parser resyncs on the next sync packet,
+// which reveals the corrupted length, independent of the sync strategy and the way of feeding.
+static void testResilientCorruptedLength() {
+  for (uint64_t corruptedLength : {uint64_t{60000}, uint64_t{3} << 20u}) {
+    std::mt19937 random(19);
+    CTestStream stream;
+    for (uint8_t i = 0; i < 20; ++i) {
+      if (i % 5 == 0) {
+        stream.add(CMhasSyncPacket());
+      }
+      ilo::ByteBuffer payload = makeFramePayload(random, 200, false);
+      payload[1] = i;
+      if (i == 7) {
+        addCorruptedFrame(stream, corruptedLength, payload);
+      } else {
+        stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), false));
+      }
+    }
+
+    for (auto strategy : {ESyncStrategy::SyncPacket, ESyncStrategy::HeaderChain}) {
+      for (bool isLent : {false, true}) {
+        CMhasParser parser;
+        parser.errorHandling(EErrorHandling::Resilient);
+        parser.syncStrategy(strategy);
+
+        CPacketDeque packets;
+        uint32_t numReleased = 0;
+        const ilo::ByteBuffer& bytes = stream.data();
+        for (std::size_t offset = 0; offset < bytes.size(); offset += 100) {
+          const std::size_t size = std::min<std::size_t>(100, bytes.size() - offset);
+          if (isLent) {
+            parser.feed(lendChunk(bytes.data() + offset, size, numReleased), size);
+          } else {
+            parser.feed(bytes.data() + offset, size);
+          }
+          parser.parsePackets();
+          appendPackets(parser, packets);
+        }
+
+        // The frames up to the next sync packet cannot be located anymore
+        MHAS_CHECK(frameIndices(packets) == std::vector<uint8_t>({0, 1, 2, 3, 4, 5, 6, 10, 11, 12,
+                                                                  13, 14, 15, 16, 17, 18, 19}));
+        MHAS_CHECK(parser.errorCounters().implausibleHeaders == 1);
+        MHAS_CHECK(parser.numBytesPending() == 0);
+      }
+    }
+  }
+}
+
+// Only subscribed packet types are returned, but unsubscribed configs still enable the validation
+// of frames with AudioPreRoll
+static void testSubscriptionMask() {
+  std::mt19937 random(21);
+  CTestStream stream = makeTestStream(20, 22);
+  ilo::ByteBuffer payload = makeFramePayload(random, 100, false);
+  // Reserved combination of usacIndependencyFlag and usacExtElementPresent flags
+  payload[0] = 0xE0u;
+  stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), false));
+
+  CMhasPacketTypeMask mask;
+  mask.set(static_cast<std::size_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME));
+  CMhasParser parser;
+  parser.subscriptionMask(mask);
+  parser.errorHandling(EErrorHandling::Resilient);
+  MHAS_CHECK(parser.subscriptionMask() == mask);
+  parser.feed(stream.data());
+  parser.parsePackets();
+
+  // All frames but the invalid one at the end are returned
+  const CPacketDeque packets = parser.allAvailablePackets();
+  std::size_t numFrames = 0;
+  for (std::size_t i = 0; i + 1 < stream.packets().size(); ++i) {
+    const STestPacket& expected = stream.packets()[i];
+    if (expected.packetType == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+      MHAS_CHECK(numFrames < packets.size() && packets[numFrames]->payload() == expected.payload);
+      ++numFrames;
+    }
+  }
+  MHAS_CHECK(packets.size() == numFrames);
+  MHAS_CHECK(parser.errorCounters().invalidPayloads == 1);
+}
+
+// Returns whether the given packets match the packets of the given stream
+static bool matchesPackets(const std::vector<CMhasPacket>& packets, const CTestStream& stream) {
+  if (packets.size() != stream.packets().size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < packets.size(); ++i) {
+    const STestPacket& expected = stream.packets()[i];
+    if (packets[i].packetType() != expected.packetType ||
+        packets[i].packetLabel() != expected.packetLabel ||
+        packets[i].payload() != expected.payload) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies of the packets passed to the handler stay valid after the lent input is released
+static void testPacketHandler() {
+  const CTestStream stream = makeTestStream(30, 23);
+  std::mt19937 random(24);
+
+  for (auto storage : {EPayloadStorage::Owned, EPayloadStorage::Shared}) {
+    CMhasParser parser;
+    parser.payloadStorage(storage);
+    std::vector<CMhasPacket> packets;
+    const CPacketHandler handler = [&packets](const CMhasPacket& packet) {
+      packets.push_back(packet);
+    };
+
+    uint32_t numLent = 0;
+    uint32_t numReleased = 0;
+    std::size_t offset = 0;
+    while (offset < stream.data().size()) {
+      const std::size_t size =
+          std::min<std::size_t>(1 + random() % 3000, stream.data().size() - offset);
+      parser.feed(lendChunk(stream.data().data() + offset, size, numReleased), size);
+      ++numLent;
+      offset += size;
+      parser.parsePackets(handler);
+      MHAS_CHECK(parser.numPacketsAvailable() == 0);
+    }
+
+    MHAS_CHECK(matchesPackets(packets, stream));
+    MHAS_CHECK(parser.numBytesPending() == 0);
+    packets.clear();
+    MHAS_CHECK(numReleased == numLent);
+  }
+}
+
+// Regression test: packets queued by parsePackets() and the packet held back by a full output
+// queue are passed to the handler before any newly parsed packet
+static void testPacketHandlerAfterBlockedQueue() {
+  const CTestStream stream = makeTestStream(10, 25);
+
+  CMhasParser parser;
+  auto queue = std::make_shared<CMhasPacketQueue>(2);
+  parser.outputQueue(queue);
+  parser.feed(stream.data());
+  parser.parsePackets();
+  MHAS_CHECK(parser.isOutputBlocked());
+
+  std::vector<CMhasPacket> packets;
+  while (auto packet = queue->tryPop()) {
+    packets.push_back(*packet);
+  }
+  parser.parsePackets([&packets](const CMhasPacket& packet) { packets.push_back(packet); });
+
+  MHAS_CHECK(!parser.isOutputBlocked());
+  MHAS_CHECK(matchesPackets(packets, stream));
+}
+
+// Frames preceded by a matching, a corrupted or no CRC16 packet are verified accordingly, also if
+// CRC16 packets are not subscribed
+static void testCrcVerification() {
+  std::mt19937 random(26);
+  const ilo::ByteBuffer config = makeConfig();
+  CTestStream stream;
+  stream.add(CMhasSyncPacket());
+  stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+
+  const std::vector<ECrcStatus> expectedStatus = {ECrcStatus::Passed, ECrcStatus::Unprotected,
+                                                  ECrcStatus::Failed, ECrcStatus::Unprotected,
+                                                  ECrcStatus::Passed};
+  for (std::size_t i = 0; i < expectedStatus.size(); ++i) {
+    const ilo::ByteBuffer payload = makeFramePayload(random, 500, i == 0);
+    SByteSpan span;
+    span.data = payload.data();
+    span.size = payload.size();
+    const uint16_t crc = CMhasCrc16::s_calculate(span);
+    if (expectedStatus[i] == ECrcStatus::Passed) {
+      stream.add(CMhasCRC16Packet(1, crc));
+    } else if (expectedStatus[i] == ECrcStatus::Failed) {
+      stream.add(CMhasCRC16Packet(1, static_cast<uint16_t>(crc ^ 0x0100u)));
+    } else if (i == 3) {
+      // A CRC16 packet of another label does not protect the frame
+      stream.add(CMhasCRC16Packet(2, crc));
+    }
+    stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  }
+
+  CMhasPacketTypeMask framesOnly;
+  framesOnly.set(static_cast<std::size_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME));
+  for (bool isSubscribed : {true, false}) {
+    for (bool isVerified : {true, false}) {
+      CMhasParser parser;
+      parser.crcVerification(isVerified);
+      MHAS_CHECK(parser.crcVerification() == isVerified);
+      if (!isSubscribed) {
+        parser.subscriptionMask(framesOnly);
+      }
+      const CPacketDeque packets = parseInChunks(parser, stream.data(), 40, 27);
+
+      std::vector<ECrcStatus> status;
+      for (const auto& packet : packets) {
+        if (packet->packetType() == static_cast<uint32_t>(EMhasPacketType::PACTYP_MPEGH3DAFRAME)) {
+          status.push_back(packet->crcStatus());
+        }
+      }
+      const SMhasCrcCounters& counters = parser.crcCounters();
+      if (isVerified) {
+        MHAS_CHECK(status == expectedStatus);
+        MHAS_CHECK(counters.passed == 2 && counters.failed == 1 && counters.unprotected == 2);
+      } else {
+        MHAS_CHECK(status == std::vector<ECrcStatus>(expectedStatus.size(),
+                                                     ECrcStatus::NotVerified));
+        MHAS_CHECK(counters.passed == 0 && counters.failed == 0 && counters.unprotected == 0);
+      }
+
+      parser.resetCrcCounters();
+      MHAS_CHECK(parser.crcCounters().passed == 0 && parser.crcCounters().failed == 0);
+    }
+  }
+}
+
+int main() {
+  runTest("LentBuffer", testLentBuffer);
+  runTest("LentBufferSharedPayload", testLentBufferSharedPayload);
+  runTest("SyncPacketAtEndOfStream", testSyncPacketAtEndOfStream);
+  runTest("SyncPacketSplitBetweenFeeds", testSyncPacketSplitBetweenFeeds);
+  runTest("HeaderChainLock", testHeaderChainLock);
+  runTest("SyncPacketStrategyIgnoresHeaderChain", testSyncPacketStrategyIgnoresHeaderChain);
+  runTest("HeaderChainSyncPacketWithLabelChange", testHeaderChainSyncPacketWithLabelChange);
+  runTest("HeaderChainPendingBytesBounded", testHeaderChainPendingBytesBounded);
+  runTest("ResilientInvalidPayload", testResilientInvalidPayload);
+  runTest("ResilientCorruptedLength", testResilientCorruptedLength);
+  runTest("SubscriptionMask", testSubscriptionMask);
+  runTest("PacketHandler", testPacketHandler);
+  runTest("PacketHandlerAfterBlockedQueue", testPacketHandlerAfterBlockedQueue);
+  runTest("CrcVerification", testCrcVerification);
+  return testResult();
+}
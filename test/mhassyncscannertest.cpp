@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <random>
+
+// External includes
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mhassyncscanner.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Returns random bytes which often contain the sync pattern and parts of it
+static ilo::ByteBuffer makeSyncNoise(std::mt19937& random, std::size_t size) {
+  static const uint8_t SYNC_BYTES[] = {0xC0u, 0x01u, 0xA5u};
+  ilo::ByteBuffer bytes(size);
+  for (auto& byte : bytes) {
+    const auto value = static_cast<uint32_t>(random());
+    byte = (value % 4u == 0u) ? SYNC_BYTES[(value >> 8u) % 3u] : static_cast<uint8_t>(value >> 16u);
+  }
+  return bytes;
+}
+
+// The selected implementation finds the same candidate as the scalar reference for all buffer
+// lengths and alignments
+static void testFindSyncCandidate() {
+  std::cout << "sync scanner: " << syncScannerName() << std::endl;
+  std::mt19937 random(8);
+
+  for (std::size_t size = 0; size < 300; ++size) {
+    const ilo::ByteBuffer bytes = makeSyncNoise(random, size + 16);
+    for (std::size_t offset = 0; offset < 16; ++offset) {
+      const uint8_t* begin = bytes.data() + offset;
+      const uint8_t* end = begin + size;
+      for (const uint8_t* position = begin; position <= end;) {
+        const uint8_t* expected = findSyncCandidateScalar(position, end);
+        MHAS_CHECK(findSyncCandidate(position, end) == expected);
+        position = (expected == end) ? end + 1 : expected + 1;
+      }
+    }
+  }
+}
+
+// A pattern at the very end of the range is found, a pattern crossing the end is not
+static void testFindSyncCandidateAtEnd() {
+  ilo::ByteBuffer bytes(100, 0);
+  bytes[97] = 0xC0u;
+  bytes[98] = 0x01u;
+  bytes[99] = 0xA5u;
+  const uint8_t* begin = bytes.data();
+
+  MHAS_CHECK(findSyncCandidate(begin, begin + 100) == begin + 97);
+  MHAS_CHECK(findSyncCandidate(begin, begin + 99) == begin + 99);
+}
+
+int main() {
+  runTest("FindSyncCandidate", testFindSyncCandidate);
+  runTest("FindSyncCandidateAtEnd", testFindSyncCandidateAtEnd);
+  return testResult();
+}
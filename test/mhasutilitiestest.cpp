@@ -0,0 +1,193 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+// System includes
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+// External includes
+#include "ilo/bitbuffer.h"
+#include "ilo/bitparser.h"
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhashelpertools.h"
+#include "mmtmhasparserlib/mhasutilities.h"
+#include "testhelpers.h"
+
+using namespace mmt::mhasparserlib;
+using namespace mmt::mhasparserlib::test;
+
+// Values at the escape boundaries of the given codec
+template <typename TCodec>
+static std::vector<uint64_t> boundaryValues() {
+  const uint64_t firstEscape = TCodec::FIRST_ESCAPE;
+  const uint64_t secondEscape = firstEscape + TCodec::SECOND_ESCAPE;
+  return {0, 1, firstEscape - 1, firstEscape, firstEscape + 1, secondEscape - 1, secondEscape,
+          secondEscape + 1, TCodec::MAX_VALUE - 1, TCodec::MAX_VALUE};
+}
+
+// The codec round trips all boundary values and agrees with the runtime functions
+template <uint8_t First, uint8_t Second, uint8_t Third>
+static void checkCodec() {
+  using CCodec = SEscapedValueCodec<First, Second, Third>;
+  const std::vector<uint64_t> values = boundaryValues<CCodec>();
+
+  ilo::ByteBuffer codecBytes(values.size() * CCodec::MAX_BITS / 8 + 1, 0);
+  ilo::ByteBuffer runtimeBytes(codecBytes.size(), 0);
+  ilo::CBitBuffer codecBuffer(codecBytes, static_cast<uint32_t>(codecBytes.size() * 8));
+  ilo::CBitBuffer runtimeBuffer(runtimeBytes, static_cast<uint32_t>(runtimeBytes.size() * 8));
+  for (uint64_t value : values) {
+    const auto position = codecBuffer.tell();
+    CCodec::write(codecBuffer, value);
+    MHAS_CHECK(codecBuffer.tell() - position == CCodec::bits(value));
+    MHAS_CHECK(CCodec::bits(value) ==
+               tools::calculateEscapedValueBitCount(value, First, Second, Third));
+    writeEscapedValue(runtimeBuffer, value, First, Second, Third);
+  }
+  MHAS_CHECK(codecBytes == runtimeBytes);
+
+  ilo::CBitParser codecParser(codecBytes);
+  ilo::CBitParser runtimeParser(codecBytes);
+  std::size_t bitPos = 0;
+  for (uint64_t value : values) {
+    uint64_t peeked = 0;
+    MHAS_CHECK(CCodec::peek(codecBytes.data(), codecBytes.size(), bitPos, peeked));
+    MHAS_CHECK(peeked == value);
+    MHAS_CHECK(CCodec::read(codecParser) == value);
+    MHAS_CHECK(readEscapedValue(runtimeParser, First, Second, Third) == value);
+  }
+  MHAS_CHECK(bitPos == codecBuffer.tell());
+
+  // A value beyond the third field cannot be written
+  if (CCodec::MAX_VALUE < UINT64_MAX) {
+    MHAS_CHECK_THROWS(CCodec::write(codecBuffer, CCodec::MAX_VALUE + 1), std::invalid_argument);
+  }
+}
+
+static void testEscapedValueCodec() {
+  checkCodec<3, 8, 8>();
+  checkCodec<2, 8, 32>();
+  checkCodec<11, 24, 24>();
+  checkCodec<4, 8, 16>();
+  checkCodec<5, 8, 16>();
+}
+
+// Peeking stops at the end of the byte range instead of reading beyond it
+static void testPeekTruncated() {
+  using CCodec = SEscapedValueCodec<11, 24, 24>;
+  const std::size_t numBytes = (CCodec::MAX_BITS + 7) / 8;
+  ilo::ByteBuffer bytes(numBytes, 0);
+  ilo::CBitBuffer bitBuffer(bytes, static_cast<uint32_t>(bytes.size() * 8));
+  CCodec::write(bitBuffer, CCodec::MAX_VALUE);
+
+  for (std::size_t size = 0; size < numBytes; ++size) {
+    std::size_t bitPos = 0;
+    uint64_t value = 0;
+    MHAS_CHECK(!CCodec::peek(bytes.data(), size, bitPos, value));
+  }
+  std::size_t bitPos = 0;
+  uint64_t value = 0;
+  MHAS_CHECK(CCodec::peek(bytes.data(), numBytes, bitPos, value));
+  MHAS_CHECK(bitPos == CCodec::MAX_BITS);
+  MHAS_CHECK(value == CCodec::MAX_VALUE);
+}
+
+// The runtime functions reject bit widths above 63
+static void testInvalidWidths() {
+  ilo::ByteBuffer bytes(32, 0);
+  ilo::CBitBuffer bitBuffer(bytes, static_cast<uint32_t>(bytes.size() * 8));
+  ilo::CBitParser bitParser(bytes);
+  MHAS_CHECK_THROWS(writeEscapedValue(bitBuffer, 0, 64, 8, 8), std::exception);
+  MHAS_CHECK_THROWS(writeEscapedValue(bitBuffer, 0, 3, 64, 8), std::exception);
+  MHAS_CHECK_THROWS(readEscapedValue(bitParser, 3, 8, 64), std::exception);
+  MHAS_CHECK(bitBuffer.tell() == 0);
+}
+
+int main() {
+  runTest("EscapedValueCodec", testEscapedValueCodec);
+  runTest("PeekTruncated", testPeekTruncated);
+  runTest("InvalidWidths", testInvalidWidths);
+  return testResult();
+}
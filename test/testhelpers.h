@@ -0,0 +1,384 @@
+/*-----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK MPEG-H Software
+
+Copyright (c) 2024 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. and Contributors
+All rights reserved.
+
+1. INTRODUCTION
+
+The "Fraunhofer FDK MPEG-H Software" is software that implements the ISO/MPEG
+MPEG-H 3D Audio standard for digital audio or related system features. Patent
+licenses for necessary patent claims for the Fraunhofer FDK MPEG-H Software
+(including those of Fraunhofer), for the use in commercial products and
+services, may be obtained from the respective patent owners individually and/or
+from Via LA (www.via-la.com).
+
+Fraunhofer supports the development of MPEG-H products and services by offering
+additional software, documentation, and technical advice. In addition, it
+operates the MPEG-H Trademark Program to ease interoperability testing of end-
+products. Please visit www.mpegh.com for more information.
+
+2. COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+* You must retain the complete text of this software license in redistributions
+of the Fraunhofer FDK MPEG-H Software or your modifications thereto in source
+code form.
+
+* You must retain the complete text of this software license in the
+documentation and/or other materials provided with redistributions of
+the Fraunhofer FDK MPEG-H Software or your modifications thereto in binary form.
+You must make available free of charge copies of the complete source code of
+the Fraunhofer FDK MPEG-H Software and your modifications thereto to recipients
+of copies in binary form.
+
+* The name of Fraunhofer may not be used to endorse or promote products derived
+from the Fraunhofer FDK MPEG-H Software without prior written permission.
+
+* You may not charge copyright license fees for anyone to use, copy or
+distribute the Fraunhofer FDK MPEG-H Software or your modifications thereto.
+
+* Your modified versions of the Fraunhofer FDK MPEG-H Software must carry
+prominent notices stating that you changed the software and the date of any
+change. For modified versions of the Fraunhofer FDK MPEG-H Software, the term
+"Fraunhofer FDK MPEG-H Software" must be replaced by the term "Third-Party
+Modified Version of the Fraunhofer FDK MPEG-H Software".
+
+3. No PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software. You may use this Fraunhofer FDK MPEG-H Software or modifications
+thereto only for purposes that are authorized by appropriate patent licenses.
+
+4. DISCLAIMER
+
+This Fraunhofer FDK MPEG-H Software is provided by Fraunhofer on behalf of the
+copyright holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED
+WARRANTIES, including but not limited to the implied warranties of
+merchantability and fitness for a particular purpose. IN NO EVENT SHALL THE
+COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE for any direct, indirect,
+incidental, special, exemplary, or consequential damages, including but not
+limited to procurement of substitute goods or services; loss of use, data, or
+profits, or business interruption, however caused and on any theory of
+liability, whether in contract, strict liability, or tort (including
+negligence), arising in any way out of the use of this software, even if
+advised of the possibility of such damage.
+
+5. CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Division Audio and Media Technologies - MPEG-H FDK
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+-----------------------------------------------------------------------------*/
+
+/*!
+ * @file testhelpers.h
+ *
+ * @brief Checks and MHAS stream builders shared by the unit tests
+ */
+#pragma once
+
+// System includes
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+// External includes
+#include "ilo/bitbuffer.h"
+#include "ilo/common_types.h"
+
+// Internal includes
+#include "mmtmhasparserlib/mhasconfigpacket.h"
+#include "mmtmhasparserlib/mhasframepacket.h"
+#include "mmtmhasparserlib/mhasmemoryresource.h"
+#include "mmtmhasparserlib/mhaspacket.h"
+#include "mmtmhasparserlib/mhassyncpacket.h"
+#include "mmtmhasparserlib/mhasutilities.h"
+
+namespace mmt {
+namespace mhasparserlib {
+namespace test {
+//! Returns the number of failed checks of the running test executable.
+inline uint32_t& failedChecks() {
+  static uint32_t count = 0;
+  return count;
+}
+
+//! Counts and prints a failed check.
+inline void reportFailedCheck(const char* file, int line, const char* check) {
+  ++failedChecks();
+  std::cerr << file << ":" << line << ": check failed: " << check << std::endl;
+}
+
+//! Reports a failed check if @p condition is false. The test continues in either case.
+#define MHAS_CHECK(condition)                                                             \
+  do {                                                                                    \
+    if (!(condition)) {                                                                   \
+      ::mmt::mhasparserlib::test::reportFailedCheck(__FILE__, __LINE__, #condition);      \
+    }                                                                                     \
+  } while (false)
+
+//! Reports a failed check if @p statement does not throw an exception of type @p exception.
+#define MHAS_CHECK_THROWS(statement, exception)                                           \
+  do {                                                                                    \
+    bool isThrown = false;                                                                \
+    try {                                                                                 \
+      statement;                                                                          \
+    } catch (const exception&) {                                                          \
+      isThrown = true;                                                                    \
+    }                                                                                     \
+    if (!isThrown) {                                                                      \
+      ::mmt::mhasparserlib::test::reportFailedCheck(__FILE__, __LINE__,                   \
+                                                    #statement " throws " #exception);    \
+    }                                                                                     \
+  } while (false)
+
+//! Runs the given test function and reports an escaping exception as a failed check.
+inline void runTest(const char* name, void (*test)()) {
+  const uint32_t failedBefore = failedChecks();
+  try {
+    test();
+  } catch (const std::exception& e) {
+    ++failedChecks();
+    std::cerr << name << ": unexpected exception: " << e.what() << std::endl;
+  }
+  std::cout << (failedChecks() == failedBefore ? "[  OK  ] " : "[FAILED] ") << name << std::endl;
+}
+
+//! Returns the exit code of the test executable, which is non-zero if any check failed.
+inline int testResult() {
+  if (failedChecks() != 0) {
+    std::cerr << failedChecks() << " check(s) failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/*!
+ * @brief Memory resource counting the allocations it forwards to the default resource.
+ *
+ * Memory may be deallocated from any thread.
+ */
+class CCountingMemoryResource : public CMhasMemoryResource {
+ public:
+  //! Returns the number of allocations of exactly @p bytes made so far.
+  uint32_t numAllocations(std::size_t bytes) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_numAllocations.find(bytes);
+    return it == m_numAllocations.end() ? 0u : it->second;
+  }
+
+  //! Returns the number of allocations made so far.
+  uint32_t numAllocations() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t count = 0;
+    for (const auto& entry : m_numAllocations) {
+      count += entry.second;
+    }
+    return count;
+  }
+
+  //! Returns the number of bytes allocated and not yet deallocated.
+  std::size_t allocatedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocatedBytes;
+  }
+
+ protected:
+  void* doAllocate(std::size_t bytes, std::size_t alignment) override {
+    void* pointer = s_defaultResource()->allocate(bytes, alignment);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_numAllocations[bytes];
+    m_allocatedBytes += bytes;
+    return pointer;
+  }
+
+  void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+    s_defaultResource()->deallocate(pointer, bytes, alignment);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocatedBytes -= bytes;
+  }
+
+ private:
+  mutable std::mutex m_mutex;
+  std::map<std::size_t, uint32_t> m_numAllocations;
+  std::size_t m_allocatedBytes = 0;
+};
+
+//! Returns @p size random bytes.
+inline ilo::ByteBuffer randomBytes(std::mt19937& random, std::size_t size) {
+  ilo::ByteBuffer bytes(size);
+  for (auto& byte : bytes) {
+    byte = static_cast<uint8_t>(random());
+  }
+  return bytes;
+}
+
+/*!
+ * @brief Returns a stereo mpegh3daConfig with 48 kHz and 1024 samples per frame.
+ *
+ * If @p audioPreRoll is set, the config starts with an AudioPreRoll extension element, so frames
+ * are validated and IPFs are detected by the parser. If @p numBits is given, it is set to the size
+ * of the config in bits without the padding of the last byte.
+ */
+inline ilo::ByteBuffer makeConfig(bool audioPreRoll = true, std::size_t* numBits = nullptr) {
+  ilo::ByteBuffer config(16, 0);
+  ilo::CBitBuffer bitBuffer(config, static_cast<uint32_t>(config.size() * 8));
+
+  // mpegh3daProfileLevelIndication: LC profile level 3
+  bitBuffer.write(0x0Du, 8);
+  // usacSamplingFrequencyIndex: 48 kHz
+  bitBuffer.write(3u, 5);
+  // coreSbrFrameLengthIndex: 1024 samples without SBR
+  bitBuffer.write(1u, 3);
+  // cfg_reserved + receiverDelayCompensation
+  bitBuffer.write(0u, 2);
+
+  // SpeakerConfig3d(): speakerLayoutType 0 with CICPspeakerLayoutIdx 2 (stereo)
+  bitBuffer.write(0u, 2);
+  bitBuffer.write(2u, 6);
+
+  // FrameworkConfig3d(): a single channel signal group of two signals using the reference layout
+  bitBuffer.write(0u, 5);
+  bitBuffer.write(0u, 3);
+  writeEscaped<5, 8, 16>(bitBuffer, 1);
+  bitBuffer.write(0u, 1);
+
+  // mpegh3daDecoderConfig(): numElements - 1 and elementLengthPresent
+  writeEscaped<4, 8, 16>(bitBuffer, audioPreRoll ? 1 : 0);
+  bitBuffer.write(0u, 1);
+  if (audioPreRoll) {
+    // ID_USAC_EXT of type ID_EXT_ELE_AUDIOPREROLL without config, default length or fragments
+    bitBuffer.write(3u, 2);
+    writeEscaped<4, 8, 16>(bitBuffer, 3);
+    writeEscaped<4, 8, 16>(bitBuffer, 0);
+    bitBuffer.write(0u, 2);
+  }
+  // ID_USAC_CPE: mpegh3daCoreConfig(), qceIndex, shiftIndex1 and lpdStereoIndex all zero
+  bitBuffer.write(1u, 2);
+  bitBuffer.write(0u, 4);
+  bitBuffer.write(0u, 4);
+
+  // usacConfigExtensionPresent
+  bitBuffer.write(0u, 1);
+
+  if (numBits != nullptr) {
+    *numBits = bitBuffer.tell();
+  }
+  config.resize((bitBuffer.tell() + 7) / 8);
+  return config;
+}
+
+/*!
+ * @brief Returns a frame payload of @p size bytes (at least 3) for a config with AudioPreRoll.
+ *
+ * An IPF starts with an AudioPreRoll extension payload without config and pre-roll AUs, all
+ * other frames are neither IPF nor IF. The remaining bytes are random.
+ */
+inline ilo::ByteBuffer makeFramePayload(std::mt19937& random, std::size_t size, bool isIPF) {
+  ilo::ByteBuffer payload = randomBytes(random, size < 3 ? 3 : size);
+  if (isIPF) {
+    // usacIndependencyFlag, usacExtElementPresent, usacExtElementUseDefaultLength = 0 and an
+    // usacExtElementPayloadLength of one byte holding an empty AudioPreRoll()
+    payload[0] = 0xC0u;
+    payload[1] = 0x20u;
+    payload[2] = static_cast<uint8_t>(payload[2] & 0x1Fu);
+  } else {
+    payload[0] = static_cast<uint8_t>(payload[0] & 0x3Fu);
+  }
+  return payload;
+}
+
+//! Type, label and payload of a packet written to a @ref CTestStream.
+struct STestPacket {
+  uint32_t packetType = 0;
+  uint64_t packetLabel = 0;
+  ilo::ByteBuffer payload;
+};
+
+//! MHAS byte stream together with the packets it was built from.
+class CTestStream {
+ public:
+  //! Appends the given packet to the stream.
+  void add(const CMhasPacket& packet) {
+    ilo::ByteBuffer bytes;
+    packet.writePacket(bytes);
+    m_data.insert(m_data.end(), bytes.begin(), bytes.end());
+
+    STestPacket info;
+    info.packetType = packet.packetType();
+    info.packetLabel = packet.packetLabel();
+    info.payload = packet.payload();
+    m_packets.push_back(std::move(info));
+  }
+
+  //! Appends bytes which are not part of any packet.
+  void addGarbage(const ilo::ByteBuffer& bytes) {
+    m_data.insert(m_data.end(), bytes.begin(), bytes.end());
+  }
+
+  const ilo::ByteBuffer& data() const { return m_data; }
+  const std::vector<STestPacket>& packets() const { return m_packets; }
+
+ private:
+  ilo::ByteBuffer m_data;
+  std::vector<STestPacket> m_packets;
+};
+
+/*!
+ * @brief Returns a stream with @p numFrames frames of label 1.
+ *
+ * Every 8th frame is an IPF and preceded by a sync packet and a config with AudioPreRoll. Frame
+ * sizes are random between 3 and @p maxFrameSize bytes.
+ */
+inline CTestStream makeTestStream(uint32_t numFrames, uint32_t seed,
+                                  std::size_t maxFrameSize = 1500) {
+  std::mt19937 random(seed);
+  const ilo::ByteBuffer config = makeConfig();
+
+  CTestStream stream;
+  for (uint32_t i = 0; i < numFrames; ++i) {
+    const bool isIPF = i % 8 == 0;
+    if (isIPF) {
+      stream.add(CMhasSyncPacket());
+      stream.add(CMhasConfigPacket(1, config.begin(), config.end()));
+    }
+    const ilo::ByteBuffer payload = makeFramePayload(random, 3 + random() % maxFrameSize, isIPF);
+    stream.add(CMhasFramePacket(1, payload.begin(), payload.end(), true));
+  }
+  return stream;
+}
+
+//! Returns whether the given packets match the packets of @p stream starting at @p first.
+inline bool matchesPackets(const CPacketDeque& packets, const CTestStream& stream,
+                           std::size_t first = 0) {
+  if (first + packets.size() > stream.packets().size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < packets.size(); ++i) {
+    const STestPacket& expected = stream.packets()[first + i];
+    if (packets[i]->packetType() != expected.packetType ||
+        packets[i]->packetLabel() != expected.packetLabel ||
+        packets[i]->payload() != expected.payload) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace test
+}  // namespace mhasparserlib
+}  // namespace mmt